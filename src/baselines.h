@@ -0,0 +1,370 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <random>
+#include <set>
+#include <vector>
+
+// Baseline indexes that the workloads can run against instead of DASL. Each
+// adapter offers the operations the workloads issue: Insert (duplicates are
+// ignored, as in DASL), Contains, Scan, which visits scan_num keys from the
+// first one >= key and returns the last like SkipList::Scan, and Size.
+
+#define SORTED_BUFFER_SIZE 4096 // Keys inserted into the sorted vector's buffer before a merge
+#define BTREE_FANOUT 64 // Keys per B+-tree node, as ARR_SIZE
+#define CLASSIC_MAX_HEIGHT 12 // LevelDB's kMaxHeight
+#define CLASSIC_BRANCHING 4 // LevelDB's kBranching
+#define CLASSIC_ARENA_BLOCK 4096 // LevelDB's arena block size
+
+template<typename Key>
+class StdSetIndex {
+   public:
+    static const char* Name() { return "std::set"; }
+
+    inline void Insert(const Key& key) { set_.insert(key); }
+    inline bool Contains(const Key& key) const { return set_.find(key) != set_.end(); }
+    Key Scan(const Key& key, const int scan_num) const;
+    inline size_t Size() const { return set_.size(); }
+
+   private:
+    std::set<Key> set_;
+};
+
+template<typename Key>
+Key StdSetIndex<Key>::Scan(const Key& key, const int scan_num) const {
+    Key last = Key();
+    auto it = set_.lower_bound(key);
+    for (int i = 0; i < scan_num && it != set_.end(); i++, ++it) last = *it;
+    return last;
+}
+
+// Sorted array searched by binary search. Inserts go to a small sorted buffer
+// that is merged into the array once it holds SORTED_BUFFER_SIZE keys, so a
+// write-heavy run does not move the whole array on every insert.
+template<typename Key>
+class SortedVectorIndex {
+   public:
+    static const char* Name() { return "sorted vector"; }
+
+    void Insert(const Key& key);
+    inline bool Contains(const Key& key) const {
+        return std::binary_search(keys_.begin(), keys_.end(), key) || std::binary_search(buffer_.begin(), buffer_.end(), key);
+    }
+    Key Scan(const Key& key, const int scan_num) const;
+    inline size_t Size() const { return keys_.size() + buffer_.size(); }
+
+   private:
+    std::vector<Key> keys_;
+    std::vector<Key> buffer_;
+
+    void Merge();
+};
+
+template<typename Key>
+void SortedVectorIndex<Key>::Insert(const Key& key) {
+    if (std::binary_search(keys_.begin(), keys_.end(), key)) return;
+    auto pos = std::lower_bound(buffer_.begin(), buffer_.end(), key);
+    if (pos != buffer_.end() && *pos == key) return;
+    buffer_.insert(pos, key);
+    if (buffer_.size() >= SORTED_BUFFER_SIZE) Merge();
+}
+
+template<typename Key>
+void SortedVectorIndex<Key>::Merge() {
+    std::vector<Key> merged(keys_.size() + buffer_.size());
+    std::merge(keys_.begin(), keys_.end(), buffer_.begin(), buffer_.end(), merged.begin());
+    keys_.swap(merged);
+    buffer_.clear();
+}
+
+template<typename Key>
+Key SortedVectorIndex<Key>::Scan(const Key& key, const int scan_num) const {
+    Key last = Key();
+    auto a = std::lower_bound(keys_.begin(), keys_.end(), key);
+    auto b = std::lower_bound(buffer_.begin(), buffer_.end(), key);
+    for (int i = 0; i < scan_num && (a != keys_.end() || b != buffer_.end()); i++) {
+        if (b == buffer_.end() || (a != keys_.end() && *a < *b)) last = *a++;
+        else last = *b++;
+    }
+    return last;
+}
+
+// In-memory B+-tree with BTREE_FANOUT keys per node and linked leaves. Full
+// nodes are split in half on the way back up from the insert.
+template<typename Key>
+class BPlusTreeIndex {
+   public:
+    BPlusTreeIndex() : root_(new Leaf()), size_(0) {}
+    ~BPlusTreeIndex() { Free(root_); }
+    BPlusTreeIndex(const BPlusTreeIndex&) = delete;
+    BPlusTreeIndex& operator=(const BPlusTreeIndex&) = delete;
+
+    static const char* Name() { return "B+-tree"; }
+
+    void Insert(const Key& key);
+    bool Contains(const Key& key) const;
+    Key Scan(const Key& key, const int scan_num) const;
+    inline size_t Size() const { return size_; }
+
+   private:
+    struct Node {
+        bool leaf;
+        int n;
+        Key keys[BTREE_FANOUT];
+        explicit Node(bool is_leaf) : leaf(is_leaf), n(0) {}
+    };
+    struct Leaf : Node {
+        Leaf* next;
+        Leaf() : Node(true), next(nullptr) {}
+    };
+    struct Inner : Node {
+        Node* children[BTREE_FANOUT + 1]; // children[i] holds keys in [keys[i - 1], keys[i])
+        Inner() : Node(false) {}
+    };
+
+    Node* root_;
+    size_t size_;
+
+    Node* InsertInto(Node* node, const Key& key, Key* separator); // The new right sibling if node split
+    const Leaf* FindLeaf(const Key& key) const;
+    static void Free(Node* node);
+};
+
+template<typename Key>
+void BPlusTreeIndex<Key>::Free(Node* node) {
+    if (node->leaf) {
+        delete static_cast<Leaf*>(node);
+        return;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    for (int i = 0; i <= inner->n; i++) Free(inner->children[i]);
+    delete inner;
+}
+
+template<typename Key>
+void BPlusTreeIndex<Key>::Insert(const Key& key) {
+    Key separator;
+    Node* right = InsertInto(root_, key, &separator);
+    if (right == nullptr) return;
+    Inner* root = new Inner();
+    root->n = 1;
+    root->keys[0] = separator;
+    root->children[0] = root_;
+    root->children[1] = right;
+    root_ = root;
+}
+
+template<typename Key>
+typename BPlusTreeIndex<Key>::Node* BPlusTreeIndex<Key>::InsertInto(Node* node, const Key& key, Key* separator) {
+    if (node->leaf) {
+        Leaf* leaf = static_cast<Leaf*>(node);
+        int pos = std::lower_bound(leaf->keys, leaf->keys + leaf->n, key) - leaf->keys;
+        if (pos < leaf->n && leaf->keys[pos] == key) return nullptr;
+        size_++;
+
+        Leaf* right = nullptr;
+        if (leaf->n == BTREE_FANOUT) {
+            right = new Leaf();
+            int half = BTREE_FANOUT / 2;
+            right->n = BTREE_FANOUT - half;
+            std::copy(leaf->keys + half, leaf->keys + BTREE_FANOUT, right->keys);
+            leaf->n = half;
+            right->next = leaf->next;
+            leaf->next = right;
+            if (pos > half) {
+                leaf = right;
+                pos -= half;
+            }
+        }
+        std::copy_backward(leaf->keys + pos, leaf->keys + leaf->n, leaf->keys + leaf->n + 1);
+        leaf->keys[pos] = key;
+        leaf->n++;
+        if (right != nullptr) *separator = right->keys[0];
+        return right;
+    }
+
+    Inner* inner = static_cast<Inner*>(node);
+    int pos = std::upper_bound(inner->keys, inner->keys + inner->n, key) - inner->keys;
+    Key child_separator;
+    Node* child_right = InsertInto(inner->children[pos], key, &child_separator);
+    if (child_right == nullptr) return nullptr;
+
+    if (inner->n < BTREE_FANOUT) {
+        std::copy_backward(inner->keys + pos, inner->keys + inner->n, inner->keys + inner->n + 1);
+        std::copy_backward(inner->children + pos + 1, inner->children + inner->n + 1, inner->children + inner->n + 2);
+        inner->keys[pos] = child_separator;
+        inner->children[pos + 1] = child_right;
+        inner->n++;
+        return nullptr;
+    }
+
+    // Split a full inner node around its middle key, which moves up
+    Key keys[BTREE_FANOUT + 1];
+    Node* children[BTREE_FANOUT + 2];
+    std::copy(inner->keys, inner->keys + pos, keys);
+    keys[pos] = child_separator;
+    std::copy(inner->keys + pos, inner->keys + BTREE_FANOUT, keys + pos + 1);
+    std::copy(inner->children, inner->children + pos + 1, children);
+    children[pos + 1] = child_right;
+    std::copy(inner->children + pos + 1, inner->children + BTREE_FANOUT + 1, children + pos + 2);
+
+    int mid = (BTREE_FANOUT + 1) / 2;
+    Inner* right = new Inner();
+    inner->n = mid;
+    std::copy(keys, keys + mid, inner->keys);
+    std::copy(children, children + mid + 1, inner->children);
+    right->n = BTREE_FANOUT - mid;
+    std::copy(keys + mid + 1, keys + BTREE_FANOUT + 1, right->keys);
+    std::copy(children + mid + 1, children + BTREE_FANOUT + 2, right->children);
+    *separator = keys[mid];
+    return right;
+}
+
+template<typename Key>
+const typename BPlusTreeIndex<Key>::Leaf* BPlusTreeIndex<Key>::FindLeaf(const Key& key) const {
+    const Node* node = root_;
+    while (!node->leaf) {
+        const Inner* inner = static_cast<const Inner*>(node);
+        node = inner->children[std::upper_bound(inner->keys, inner->keys + inner->n, key) - inner->keys];
+    }
+    return static_cast<const Leaf*>(node);
+}
+
+template<typename Key>
+bool BPlusTreeIndex<Key>::Contains(const Key& key) const {
+    const Leaf* leaf = FindLeaf(key);
+    return std::binary_search(leaf->keys, leaf->keys + leaf->n, key);
+}
+
+template<typename Key>
+Key BPlusTreeIndex<Key>::Scan(const Key& key, const int scan_num) const {
+    Key last = Key();
+    const Leaf* leaf = FindLeaf(key);
+    int pos = std::lower_bound(leaf->keys, leaf->keys + leaf->n, key) - leaf->keys;
+    for (int i = 0; i < scan_num && leaf != nullptr; leaf = leaf->next, pos = 0) {
+        for (; pos < leaf->n && i < scan_num; pos++, i++) last = leaf->keys[pos];
+    }
+    return last;
+}
+
+// Pointer-based skip list as in LevelDB's memtable: one key per node, towers
+// of up to CLASSIC_MAX_HEIGHT next pointers with 1/CLASSIC_BRANCHING of the
+// nodes on each higher level, and nodes carved out of an arena.
+template<typename Key>
+class ClassicSkipList {
+   public:
+    ClassicSkipList();
+    ~ClassicSkipList();
+    ClassicSkipList(const ClassicSkipList&) = delete;
+    ClassicSkipList& operator=(const ClassicSkipList&) = delete;
+
+    static const char* Name() { return "LevelDB skiplist"; }
+
+    void Insert(const Key& key);
+    bool Contains(const Key& key) const;
+    Key Scan(const Key& key, const int scan_num) const;
+    inline size_t Size() const { return size_; }
+
+   private:
+    struct Node {
+        Key key;
+        Node* next[1]; // Allocated with one slot per level of the node
+    };
+
+    Node* head_;
+    int max_height_;
+    size_t size_;
+    std::minstd_rand0 rnd_; // LevelDB's Random, seeded alike
+    std::vector<char*> blocks_;
+    char* alloc_ptr_;
+    size_t alloc_remaining_;
+
+    Node* NewNode(const Key& key, int height);
+    int RandomHeight();
+    Node* FindGreaterOrEqual(const Key& key, Node** prev) const; // Fills prev[level] when not null
+};
+
+template<typename Key>
+ClassicSkipList<Key>::ClassicSkipList() : max_height_(1), size_(0), rnd_(0xdeadbeef), alloc_ptr_(nullptr), alloc_remaining_(0) {
+    head_ = NewNode(Key(), CLASSIC_MAX_HEIGHT);
+    for (int i = 0; i < CLASSIC_MAX_HEIGHT; i++) head_->next[i] = nullptr;
+}
+
+template<typename Key>
+ClassicSkipList<Key>::~ClassicSkipList() {
+    for (char* block : blocks_) delete[] block;
+}
+
+template<typename Key>
+typename ClassicSkipList<Key>::Node* ClassicSkipList<Key>::NewNode(const Key& key, int height) {
+    size_t bytes = sizeof(Node) + sizeof(Node*) * (height - 1);
+    bytes = (bytes + alignof(Node) - 1) & ~(alignof(Node) - 1);
+    if (bytes > alloc_remaining_) {
+        alloc_ptr_ = new char[CLASSIC_ARENA_BLOCK];
+        alloc_remaining_ = CLASSIC_ARENA_BLOCK;
+        blocks_.push_back(alloc_ptr_);
+    }
+    Node* node = new (alloc_ptr_) Node;
+    alloc_ptr_ += bytes;
+    alloc_remaining_ -= bytes;
+    node->key = key;
+    return node;
+}
+
+template<typename Key>
+int ClassicSkipList<Key>::RandomHeight() {
+    int height = 1;
+    while (height < CLASSIC_MAX_HEIGHT && rnd_() % CLASSIC_BRANCHING == 0) height++;
+    return height;
+}
+
+template<typename Key>
+typename ClassicSkipList<Key>::Node* ClassicSkipList<Key>::FindGreaterOrEqual(const Key& key, Node** prev) const {
+    Node* x = head_;
+    int level = max_height_ - 1;
+    while (true) {
+        Node* next = x->next[level];
+        if (next != nullptr && next->key < key) {
+            x = next;
+        } else {
+            if (prev != nullptr) prev[level] = x;
+            if (level == 0) return next;
+            level--;
+        }
+    }
+}
+
+template<typename Key>
+void ClassicSkipList<Key>::Insert(const Key& key) {
+    Node* prev[CLASSIC_MAX_HEIGHT];
+    Node* x = FindGreaterOrEqual(key, prev);
+    if (x != nullptr && x->key == key) return;
+
+    int height = RandomHeight();
+    if (height > max_height_) {
+        for (int i = max_height_; i < height; i++) prev[i] = head_;
+        max_height_ = height;
+    }
+    x = NewNode(key, height);
+    for (int i = 0; i < height; i++) {
+        x->next[i] = prev[i]->next[i];
+        prev[i]->next[i] = x;
+    }
+    size_++;
+}
+
+template<typename Key>
+bool ClassicSkipList<Key>::Contains(const Key& key) const {
+    Node* x = FindGreaterOrEqual(key, nullptr);
+    return x != nullptr && x->key == key;
+}
+
+template<typename Key>
+Key ClassicSkipList<Key>::Scan(const Key& key, const int scan_num) const {
+    Key last = Key();
+    Node* x = FindGreaterOrEqual(key, nullptr);
+    for (int i = 0; i < scan_num && x != nullptr; i++, x = x->next[0]) last = x->key;
+    return last;
+}
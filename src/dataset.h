@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "skiplist.h"
+
+#define DATASET_DIR "./dataset/" // Where <name>.bin and <name>.txt are looked up
+
+// Keys of a real-world dataset, mapped read-only from a SOSD binary file: a
+// uint64 key count followed by the keys as uint64. Only <name>.bin is ever
+// read by the benchmarks; if it is missing, the one-key-per-line <name>.txt
+// is converted into it once, in parallel.
+class Dataset {
+   public:
+    Dataset() : map_(MAP_FAILED), map_bytes_(0), keys_(nullptr), size_(0) {}
+    ~Dataset();
+    Dataset(const Dataset&) = delete;
+    Dataset& operator=(const Dataset&) = delete;
+
+    bool Load(const std::string& name); // Map DATASET_DIR/<name>.bin, converting <name>.txt first if needed
+
+    inline const Key* data() const { return keys_; }
+    inline size_t size() const { return size_; }
+
+    // Parse a text file of decimal keys into a SOSD binary file with threads
+    // workers, each writing its share of the lines straight into the output
+    static bool ConvertText(const std::string& text_path, const std::string& bin_path, int threads);
+
+   private:
+    void* map_;
+    size_t map_bytes_;
+    const Key* keys_;
+    size_t size_;
+};
+
+inline Dataset::~Dataset() {
+    if (map_ != MAP_FAILED) munmap(map_, map_bytes_);
+}
+
+inline bool Dataset::Load(const std::string& name) {
+    std::string bin_path = DATASET_DIR + name + ".bin";
+    std::string text_path = DATASET_DIR + name + ".txt";
+    if (access(bin_path.c_str(), R_OK) != 0) {
+        int threads = std::max(1u, std::thread::hardware_concurrency());
+        printf("Converting %s to %s with %d threads\n", text_path.c_str(), bin_path.c_str(), threads);
+        if (!ConvertText(text_path, bin_path, threads)) return false;
+    }
+
+    int fd = open(bin_path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(uint64_t)) {
+        close(fd);
+        return false;
+    }
+    map_bytes_ = st.st_size;
+    map_ = mmap(nullptr, map_bytes_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map_ == MAP_FAILED) return false;
+
+    const uint64_t* words = static_cast<const uint64_t*>(map_);
+    size_ = words[0];
+    if (size_ > (map_bytes_ - sizeof(uint64_t)) / sizeof(Key)) { // Truncated file
+        size_ = 0;
+        return false;
+    }
+    keys_ = reinterpret_cast<const Key*>(words + 1);
+    return true;
+}
+
+inline bool Dataset::ConvertText(const std::string& text_path, const std::string& bin_path, int threads) {
+    int in = open(text_path.c_str(), O_RDONLY);
+    if (in < 0) return false;
+    struct stat st;
+    if (fstat(in, &st) != 0 || st.st_size == 0) {
+        close(in);
+        return false;
+    }
+    size_t text_bytes = st.st_size;
+    void* text_map = mmap(nullptr, text_bytes, PROT_READ, MAP_PRIVATE, in, 0);
+    close(in);
+    if (text_map == MAP_FAILED) return false;
+    const char* text = static_cast<const char*>(text_map);
+    madvise(text_map, text_bytes, MADV_SEQUENTIAL);
+
+    // Chunk boundaries moved forward to line starts, so no key is split
+    std::vector<size_t> bounds(threads + 1, text_bytes);
+    bounds[0] = 0;
+    for (int t = 1; t < threads; t++) {
+        size_t pos = std::max(bounds[t - 1], text_bytes / threads * t);
+        while (pos < text_bytes && pos > 0 && text[pos - 1] != '\n') pos++;
+        bounds[t] = pos;
+    }
+
+    // A key is a run of digits; count each chunk's keys to place its output
+    auto forEachKey = [text](size_t begin, size_t end, auto&& emit) {
+        size_t pos = begin;
+        while (pos < end) {
+            while (pos < end && (text[pos] < '0' || text[pos] > '9')) pos++;
+            if (pos == end) break;
+            uint64_t key = 0;
+            while (pos < end && text[pos] >= '0' && text[pos] <= '9') key = key * 10 + (text[pos++] - '0');
+            emit(key);
+        }
+    };
+    std::vector<size_t> counts(threads + 1, 0);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            size_t n = 0;
+            forEachKey(bounds[t], bounds[t + 1], [&n](uint64_t) { n++; });
+            counts[t + 1] = n;
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    workers.clear();
+    for (int t = 0; t < threads; t++) counts[t + 1] += counts[t];
+
+    // Write into a preallocated temporary file, renamed once complete
+    std::string tmp_path = bin_path + ".tmp";
+    int out = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    size_t bin_bytes = sizeof(uint64_t) * (1 + counts[threads]);
+    void* bin_map = MAP_FAILED;
+    if (out >= 0 && ftruncate(out, bin_bytes) == 0) {
+        bin_map = mmap(nullptr, bin_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, out, 0);
+    }
+    if (out >= 0) close(out);
+    if (bin_map == MAP_FAILED) {
+        munmap(text_map, text_bytes);
+        unlink(tmp_path.c_str());
+        return false;
+    }
+
+    uint64_t* words = static_cast<uint64_t*>(bin_map);
+    words[0] = counts[threads];
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            uint64_t* slot = words + 1 + counts[t];
+            forEachKey(bounds[t], bounds[t + 1], [&slot](uint64_t key) { *slot++ = key; });
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    bool ok = msync(bin_map, bin_bytes, MS_SYNC) == 0;
+    munmap(bin_map, bin_bytes);
+    munmap(text_map, text_bytes);
+    if (ok) ok = rename(tmp_path.c_str(), bin_path.c_str()) == 0;
+    if (!ok) unlink(tmp_path.c_str());
+    return ok;
+}
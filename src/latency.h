@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cpuid.h>
+#include <x86intrin.h>
+
+#define HIST_PRECISION 7 // Sub-bucket bits: values within 2^-7 (< 0.8%) share a bucket
+#define HIST_SUB_BUCKETS (1 << HIST_PRECISION)
+#define HIST_BUCKETS ((64 - HIST_PRECISION + 1) * HIST_SUB_BUCKETS) // Values below HIST_SUB_BUCKETS, then one run per bit width
+#define TSC_CALIBRATION_MS 20 // Wall time the tick rate is measured over
+
+// Time stamp counter read around a single operation. rdtsc is fenced so the
+// operation cannot start before Start, and rdtscp waits for it to retire before
+// Stop. The tick rate is measured against steady_clock once at construction;
+// without an invariant TSC the readings are steady_clock nanoseconds instead.
+class TscClock {
+   public:
+    TscClock();
+
+    inline uint64_t Start() const {
+        if (!invariant_) return Nanos();
+        _mm_lfence();
+        uint64_t t = __rdtsc();
+        _mm_lfence();
+        return t;
+    }
+
+    inline uint64_t Stop() const {
+        if (!invariant_) return Nanos();
+        unsigned int aux;
+        uint64_t t = __rdtscp(&aux);
+        _mm_lfence();
+        return t;
+    }
+
+    // Ticks from start to stop, 0 if stop reads earlier, as it can after the
+    // thread moved to a core whose counter lags; per-operation spans go through
+    // LatencyHistogram::RecordSpan, which drops them instead
+    static inline uint64_t Elapsed(uint64_t start, uint64_t stop) { return stop > start ? stop - start : 0; }
+
+    inline uint64_t ToNs(uint64_t ticks) const { return invariant_ ? (uint64_t)(ticks * ns_per_tick_) : ticks; }
+    inline double TicksPerNs() const { return invariant_ ? 1.0 / ns_per_tick_ : 1.0; }
+    inline bool Invariant() const { return invariant_; }
+
+   private:
+    bool invariant_;
+    double ns_per_tick_;
+
+    static inline uint64_t Nanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+inline TscClock::TscClock() : invariant_(false), ns_per_tick_(1.0) {
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0 || (edx & (1 << 8)) == 0) return;
+
+    auto wall_start = std::chrono::steady_clock::now();
+    uint64_t tsc_start = __rdtsc();
+    while (std::chrono::steady_clock::now() - wall_start < std::chrono::milliseconds(TSC_CALIBRATION_MS)) {}
+    auto wall_end = std::chrono::steady_clock::now();
+    uint64_t tsc_end = __rdtsc();
+
+    double ns = std::chrono::duration<double, std::nano>(wall_end - wall_start).count();
+    if (tsc_end <= tsc_start || ns <= 0) return;
+    ns_per_tick_ = ns / (tsc_end - tsc_start);
+    invariant_ = true;
+}
+
+// Log-linear latency histogram in the style of HdrHistogram: every power of two
+// is split into HIST_SUB_BUCKETS linear buckets, so any uint64 value is kept to
+// within 2^-HIST_PRECISION relative error in a fixed HIST_BUCKETS counters,
+// however many values are recorded
+class LatencyHistogram {
+   public:
+    LatencyHistogram() { Reset(); }
+
+    inline void Record(uint64_t value) {
+        counts_[Index(value)]++;
+        total_++;
+        if (value < min_) min_ = value;
+        if (value > max_) max_ = value;
+        sum_ += value;
+    }
+
+    // Records the ticks from start to stop, or drops the pair when stop reads
+    // earlier, as it can after the thread moved to a core whose counter lags
+    inline void RecordSpan(uint64_t start, uint64_t stop) {
+        if (stop < start) {
+            dropped_++;
+            return;
+        }
+        Record(stop - start);
+    }
+
+    void Merge(const LatencyHistogram& other);
+    void Reset();
+
+    uint64_t Percentile(double percentile) const; // Highest value equivalent to the bucket holding it
+    inline uint64_t Count() const { return total_; }
+    inline uint64_t Min() const { return total_ ? min_ : 0; }
+    inline uint64_t Max() const { return max_; }
+    inline double Mean() const { return total_ ? (double)sum_ / total_ : 0.0; }
+    inline uint64_t Dropped() const { return dropped_; } // Spans RecordSpan left out
+
+   private:
+    uint64_t counts_[HIST_BUCKETS];
+    uint64_t total_;
+    uint64_t min_;
+    uint64_t max_;
+    uint64_t sum_;
+    uint64_t dropped_;
+
+    static inline int Index(uint64_t value) {
+        if (value < HIST_SUB_BUCKETS) return value;
+        int shift = 63 - __builtin_clzll(value) - HIST_PRECISION;
+        return (shift + 1) * HIST_SUB_BUCKETS + (int)((value >> shift) - HIST_SUB_BUCKETS);
+    }
+
+    static inline uint64_t HighestEquivalent(int index) {
+        if (index < HIST_SUB_BUCKETS) return index;
+        int shift = index / HIST_SUB_BUCKETS - 1;
+        uint64_t low = (uint64_t)(index % HIST_SUB_BUCKETS + HIST_SUB_BUCKETS) << shift;
+        return low + ((1ULL << shift) - 1);
+    }
+};
+
+inline void LatencyHistogram::Reset() {
+    std::memset(counts_, 0, sizeof(counts_));
+    total_ = 0;
+    min_ = UINT64_MAX;
+    max_ = 0;
+    sum_ = 0;
+    dropped_ = 0;
+}
+
+inline void LatencyHistogram::Merge(const LatencyHistogram& other) {
+    for (int i = 0; i < HIST_BUCKETS; i++) counts_[i] += other.counts_[i];
+    total_ += other.total_;
+    if (other.total_ && other.min_ < min_) min_ = other.min_;
+    if (other.max_ > max_) max_ = other.max_;
+    sum_ += other.sum_;
+    dropped_ += other.dropped_;
+}
+
+inline uint64_t LatencyHistogram::Percentile(double percentile) const {
+    if (total_ == 0) return 0;
+    uint64_t target = (uint64_t)(percentile / 100.0 * total_ + 0.5);
+    if (target < 1) target = 1;
+    if (target >= total_) return max_;
+    uint64_t seen = 0;
+    for (int i = 0; i < HIST_BUCKETS; i++) {
+        seen += counts_[i];
+        if (seen >= target) return std::min(HighestEquivalent(i), max_);
+    }
+    return max_;
+}
@@ -1,24 +1,14 @@
-#include "zipf.h"
 #include "latest-generator.h"
-#include <math.h>
-#include <stdlib.h>
-#include <time.h>
-#include <stdio.h>
 
-long last_value_latestgen;
-long count_basis_latestgen;
-
-// init_val should be the same parameter as the one the zipf generator is initialized with
-void init_latestgen(long init_val){
-	count_basis_latestgen = init_val;
-	//should init the zipf generator here, but it is already initialized
-	next_value_latestgen();
+// count should be the same as the item count of the keys already loaded
+LatestGenerator::LatestGenerator(long count, double theta, uint64_t seed)
+	: count_(count), last_(0), zipf_(0, count, theta, seed) {
+	Next();
 }
 
-
-long next_value_latestgen(){
-	long max = count_basis_latestgen - 1;
-	long next = max - nextLong(max);
-	last_value_latestgen = next;
+long LatestGenerator::Next() {
+	long max = count_ - 1;
+	long next = max - zipf_.Next(max);
+	last_ = next;
 	return next;
 }
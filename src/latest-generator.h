@@ -1,5 +1,20 @@
-extern long last_value_latestgen;
-extern long count_basis_latestgen;
+#pragma once
 
-void init_latestgen(long init_val);
-long next_value_latestgen();
+#include "zipf.h"
+
+// YCSB's skewed-latest generator: Zipfian distances back from the newest of
+// count items, so recently inserted keys are the popular ones. Built on an
+// own ZipfianGenerator, so instances are independent like it.
+class LatestGenerator {
+   public:
+	LatestGenerator(long count, double theta = ZIPFIAN_CONSTANT, uint64_t seed = 0);
+
+	long Next(); // Next value in [0, count)
+	inline long Last() const { return last_; }
+	inline void SetCount(long count) { count_ = count; } // Follow inserts; zeta is extended on the next call
+
+   private:
+	long count_;
+	long last_;
+	ZipfianGenerator zipf_;
+};
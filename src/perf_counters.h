@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Receives every phase measured between PerfCounters::Begin and End, e.g. to
+// write a results file
+class PhaseSink {
+   public:
+    virtual ~PhaseSink() {}
+    virtual void Phase(const char* phase, long ops, double seconds) = 0;
+    virtual void Counter(const char* name, double per_op) = 0; // Attached to the last phase
+};
+
+// Hardware counters read as one perf_event_open group around a benchmark phase,
+// enabled by running with DASL_PERF=1. Counters the CPU, the kernel or the
+// container refuses are left out of the group, and when none opens every phase
+// falls back to wall time only. Only the calling thread is counted, so phases
+// run by worker threads (sharded, parallel bulk load) are not covered.
+class PerfCounters {
+   public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    inline bool Available() const { return leader_ >= 0; }
+    inline void SetSink(PhaseSink* sink) { sink_ = sink; }
+
+    void Begin(); // Reset and start the group
+    void End(const char* phase, long ops); // Stop the group and print counts per operation
+
+   private:
+    struct Event {
+        const char* name;
+        uint32_t type;
+        uint64_t config;
+        int fd;
+        uint64_t id;
+    };
+
+    std::vector<Event> events_; // Opened events, the leader first
+    int leader_;
+    PhaseSink* sink_; // Also gets the wall time of each phase, counters or not
+    std::chrono::steady_clock::time_point start_;
+
+    void Read(const char* phase, long ops);
+};
+
+#ifdef __linux__
+
+inline PerfCounters::PerfCounters() : leader_(-1), sink_(nullptr) {
+    const char* env = std::getenv("DASL_PERF");
+    if (env == nullptr || std::strcmp(env, "1") != 0) return;
+
+    const uint64_t cache_read_miss = (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const Event wanted[] = {
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, -1, 0},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, -1, 0},
+        {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, -1, 0},
+        {"L1d-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | cache_read_miss, -1, 0},
+        {"LLC-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, -1, 0},
+        {"dTLB-misses", PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | cache_read_miss, -1, 0},
+    };
+
+    int first_errno = 0;
+    for (const Event& want : wanted) {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = want.type;
+        attr.config = want.config;
+        attr.disabled = (leader_ < 0) ? 1 : 0; // Members follow the leader
+        attr.exclude_kernel = 1; // Allowed under perf_event_paranoid 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0);
+        if (fd < 0) {
+            if (first_errno == 0) first_errno = errno;
+            continue;
+        }
+        Event event = want;
+        event.fd = fd;
+        ioctl(fd, PERF_EVENT_IOC_ID, &event.id);
+        if (leader_ < 0) leader_ = fd;
+        events_.push_back(event);
+    }
+
+    if (!Available()) {
+        printf("[perf] counters unavailable (%s), reporting wall time only\n", std::strerror(first_errno));
+    } else if (first_errno != 0) {
+        printf("[perf] %zu of %zu counters opened (%s)\n", events_.size(), sizeof(wanted) / sizeof(wanted[0]), std::strerror(first_errno));
+    }
+}
+
+inline PerfCounters::~PerfCounters() {
+    for (const Event& event : events_) close(event.fd);
+}
+
+inline void PerfCounters::Begin() {
+    if (Available()) {
+        ioctl(leader_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    start_ = std::chrono::steady_clock::now();
+}
+
+inline void PerfCounters::End(const char* phase, long ops) {
+    auto end = std::chrono::steady_clock::now();
+    if (Available()) ioctl(leader_, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (sink_ != nullptr) sink_->Phase(phase, ops, std::chrono::duration<double>(end - start_).count());
+    if (Available()) Read(phase, ops);
+}
+
+inline void PerfCounters::Read(const char* phase, long ops) {
+    // nr, time_enabled, time_running, then a {value, id} pair per event
+    std::vector<uint64_t> data(3 + 2 * events_.size());
+    if (read(leader_, data.data(), data.size() * sizeof(uint64_t)) <= 0 || data[2] == 0) {
+        printf("[perf %s] no samples\n", phase);
+        return;
+    }
+    double scale = (double)data[1] / data[2]; // The group was multiplexed if time_running < time_enabled
+    double per_op = (ops > 0) ? 1.0 / ops : 1.0;
+
+    printf("[perf %s] per op:", phase);
+    const char* sep = " ";
+    double cycles = 0, instructions = 0;
+    for (uint64_t i = 0; i < data[0]; i++) {
+        for (const Event& event : events_) {
+            if (event.id != data[4 + 2 * i]) continue;
+            double value = data[3 + 2 * i] * scale;
+            if (event.config == PERF_COUNT_HW_CPU_CYCLES && event.type == PERF_TYPE_HARDWARE) cycles = value;
+            if (event.config == PERF_COUNT_HW_INSTRUCTIONS && event.type == PERF_TYPE_HARDWARE) instructions = value;
+            printf("%s%s = %.2lf", sep, event.name, value * per_op);
+            if (sink_ != nullptr) sink_->Counter(event.name, value * per_op);
+            sep = ", ";
+        }
+    }
+    if (cycles > 0 && instructions > 0) printf(", IPC = %.2lf", instructions / cycles);
+    printf("\n");
+}
+
+#else
+
+inline PerfCounters::PerfCounters() : leader_(-1), sink_(nullptr) {}
+inline PerfCounters::~PerfCounters() {}
+inline void PerfCounters::Begin() { start_ = std::chrono::steady_clock::now(); }
+
+inline void PerfCounters::End(const char* phase, long ops) {
+    auto end = std::chrono::steady_clock::now();
+    if (sink_ != nullptr) sink_->Phase(phase, ops, std::chrono::duration<double>(end - start_).count());
+}
+
+#endif
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include "perf_counters.h"
+
+#ifndef DASL_CXXFLAGS
+#define DASL_CXXFLAGS "" // Compiler flags of the build, passed in by the Makefile
+#endif
+
+// Machine-readable benchmark results, written when DASL_RESULTS names a file.
+// A path ending in .json or .jsonl gets one JSON object per run, anything else
+// one CSV row per phase; both append, so a sweep of runs collects in one file.
+// Phases arrive through PerfCounters, so every timed phase is recorded. Each
+// SetRun starts a new run, so one process can write a run per index it tried.
+class Results : public PhaseSink {
+   public:
+    Results();
+
+    inline bool Enabled() const { return !path_.empty(); }
+
+    void SetRun(const std::string& benchmark, const std::string& structure, int id, int write, int read, uint64_t seed);
+    void Phase(const char* phase, long ops, double seconds) override;
+    void Counter(const char* name, double per_op) override;
+    void Percentile(const char* phase, double percentile, double ns); // Attached to the last phase of that name
+    void Index(const char* name, double value); // Index statistics after the run
+
+    bool Write() const;
+
+   private:
+    struct PhaseResult {
+        std::string name;
+        long ops;
+        double seconds;
+        std::vector<std::pair<std::string, double>> counters; // Per operation
+        std::vector<std::pair<double, double>> percentiles; // Latency in ns
+    };
+
+    std::string path_;
+    std::string benchmark_;
+    std::string structure_; // Index the benchmark ran on, DASL or a baseline
+    int id_, write_, read_;
+    uint64_t seed_;
+    std::vector<PhaseResult> phases_;
+    std::vector<std::pair<std::string, double>> index_;
+    std::vector<std::pair<std::string, std::string>> meta_; // Host, compiler and time of the run
+
+    static std::string Quote(const std::string& value, bool json);
+    bool WriteJson(FILE* file) const;
+    bool WriteCsv(FILE* file, bool header) const;
+};
+
+inline Results::Results() : id_(-1), write_(0), read_(0), seed_(0) {
+    const char* env = std::getenv("DASL_RESULTS");
+    if (env == nullptr || env[0] == '\0') return;
+    path_ = env;
+
+    char buf[256];
+    time_t now = time(nullptr);
+    strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    meta_.push_back({"time", buf});
+    if (gethostname(buf, sizeof(buf)) != 0) buf[0] = '\0';
+    buf[sizeof(buf) - 1] = '\0';
+    meta_.push_back({"host", buf});
+    struct utsname uts;
+    std::string kernel;
+    if (uname(&uts) == 0) kernel = std::string(uts.sysname) + " " + uts.release + " " + uts.machine;
+    meta_.push_back({"kernel", kernel});
+
+    // Every key is present even when empty, so CSV columns line up across hosts
+    std::string model;
+    FILE* cpuinfo = fopen("/proc/cpuinfo", "r");
+    if (cpuinfo != nullptr) {
+        char line[512];
+        while (fgets(line, sizeof(line), cpuinfo) != nullptr) {
+            const char* colon = strchr(line, ':');
+            if (strncmp(line, "model name", 10) != 0 || colon == nullptr) continue;
+            model = colon + 1;
+            model.erase(0, model.find_first_not_of(" \t"));
+            model.erase(model.find_last_not_of(" \t\n") + 1);
+            break;
+        }
+        fclose(cpuinfo);
+    }
+    meta_.push_back({"cpu", model});
+    meta_.push_back({"cores", std::to_string(std::thread::hardware_concurrency())});
+    meta_.push_back({"compiler", __VERSION__});
+    meta_.push_back({"flags", DASL_CXXFLAGS});
+#ifdef __OPTIMIZE__
+    meta_.push_back({"optimized", "yes"});
+#else
+    meta_.push_back({"optimized", "no"});
+#endif
+#ifdef DASL_STATS
+    meta_.push_back({"stats", "yes"});
+#else
+    meta_.push_back({"stats", "no"});
+#endif
+}
+
+inline void Results::SetRun(const std::string& benchmark, const std::string& structure, int id, int write, int read, uint64_t seed) {
+    benchmark_ = benchmark;
+    structure_ = structure;
+    id_ = id;
+    write_ = write;
+    read_ = read;
+    seed_ = seed;
+    phases_.clear();
+    index_.clear();
+}
+
+inline void Results::Phase(const char* phase, long ops, double seconds) {
+    if (!Enabled()) return;
+    phases_.push_back({phase, ops, seconds, {}, {}});
+}
+
+inline void Results::Counter(const char* name, double per_op) {
+    if (!Enabled() || phases_.empty()) return;
+    phases_.back().counters.push_back({name, per_op});
+}
+
+inline void Results::Percentile(const char* phase, double percentile, double ns) {
+    if (!Enabled()) return;
+    for (auto it = phases_.rbegin(); it != phases_.rend(); ++it) {
+        if (it->name != phase) continue;
+        it->percentiles.push_back({percentile, ns});
+        return;
+    }
+}
+
+inline void Results::Index(const char* name, double value) {
+    if (!Enabled()) return;
+    index_.push_back({name, value});
+}
+
+inline bool Results::Write() const {
+    if (!Enabled()) return true;
+    auto endsWith = [this](const char* suffix) {
+        size_t n = strlen(suffix);
+        return path_.size() >= n && path_.compare(path_.size() - n, n, suffix) == 0;
+    };
+    bool json = endsWith(".json") || endsWith(".jsonl");
+    bool header = access(path_.c_str(), F_OK) != 0;
+    FILE* file = fopen(path_.c_str(), "a");
+    if (file == nullptr) {
+        fprintf(stderr, "Failed to open results file: %s\n", path_.c_str());
+        return false;
+    }
+    bool ok = json ? WriteJson(file) : WriteCsv(file, header);
+    return (fclose(file) == 0) && ok;
+}
+
+// Quoted and escaped for JSON, or for CSV where RFC 4180 doubles the quotes
+inline std::string Results::Quote(const std::string& value, bool json) {
+    std::string out = "\"";
+    for (char c : value) {
+        if (c == '"') out += json ? "\\\"" : "\"\"";
+        else if (json && c == '\\') out += "\\\\";
+        else if (json && (unsigned char)c < 0x20) out += ' ';
+        else out += c;
+    }
+    return out + "\"";
+}
+
+inline bool Results::WriteJson(FILE* file) const {
+    fprintf(file, "{\"benchmark\": %s, \"structure\": %s, \"id\": %d, \"write\": %d, \"read\": %d, \"seed\": %lu", Quote(benchmark_, true).c_str(), Quote(structure_, true).c_str(), id_, write_, read_, (unsigned long)seed_);
+    fprintf(file, ", \"meta\": {");
+    for (size_t i = 0; i < meta_.size(); i++) {
+        fprintf(file, "%s%s: %s", i ? ", " : "", Quote(meta_[i].first, true).c_str(), Quote(meta_[i].second, true).c_str());
+    }
+    fprintf(file, "}, \"phases\": [");
+    for (size_t i = 0; i < phases_.size(); i++) {
+        const PhaseResult& phase = phases_[i];
+        fprintf(file, "%s{\"phase\": %s, \"ops\": %ld, \"seconds\": %.9g, \"ops_per_sec\": %.9g", i ? ", " : "", Quote(phase.name, true).c_str(), phase.ops, phase.seconds, phase.seconds > 0 ? phase.ops / phase.seconds : 0.0);
+        fprintf(file, ", \"percentiles_ns\": {");
+        for (size_t j = 0; j < phase.percentiles.size(); j++) {
+            fprintf(file, "%s\"p%g\": %.9g", j ? ", " : "", phase.percentiles[j].first, phase.percentiles[j].second);
+        }
+        fprintf(file, "}, \"counters_per_op\": {");
+        for (size_t j = 0; j < phase.counters.size(); j++) {
+            fprintf(file, "%s%s: %.9g", j ? ", " : "", Quote(phase.counters[j].first, true).c_str(), phase.counters[j].second);
+        }
+        fprintf(file, "}}");
+    }
+    fprintf(file, "], \"index\": {");
+    for (size_t i = 0; i < index_.size(); i++) {
+        fprintf(file, "%s%s: %.17g", i ? ", " : "", Quote(index_[i].first, true).c_str(), index_[i].second);
+    }
+    return fprintf(file, "}}\n") > 0;
+}
+
+// Fixed columns, so the counters (which vary by host) are left to JSON, and
+// index statistics a structure does not have are left empty
+inline bool Results::WriteCsv(FILE* file, bool header) const {
+    static const double percentiles[] = {50, 99, 99.9, 99.99, 99.999};
+    static const char* index_columns[] = {"height", "splits", "shifts", "keys", "memory_bytes"};
+    if (header) {
+        for (const auto& meta : meta_) fprintf(file, "%s,", meta.first.c_str());
+        fprintf(file, "benchmark,structure,id,write,read,seed,phase,ops,seconds,ops_per_sec");
+        for (double p : percentiles) fprintf(file, ",p%g_ns", p);
+        for (const char* column : index_columns) fprintf(file, ",%s", column);
+        fprintf(file, "\n");
+    }
+    bool ok = true;
+    for (const PhaseResult& phase : phases_) {
+        for (const auto& meta : meta_) fprintf(file, "%s,", Quote(meta.second, false).c_str());
+        fprintf(file, "%s,%s,%d,%d,%d,%lu,%s,%ld,%.9g,%.9g", Quote(benchmark_, false).c_str(), Quote(structure_, false).c_str(), id_, write_, read_, (unsigned long)seed_, Quote(phase.name, false).c_str(), phase.ops, phase.seconds, phase.seconds > 0 ? phase.ops / phase.seconds : 0.0);
+        for (double p : percentiles) {
+            fprintf(file, ",");
+            for (const auto& entry : phase.percentiles) {
+                if (entry.first == p) fprintf(file, "%.9g", entry.second);
+            }
+        }
+        for (const char* column : index_columns) {
+            fprintf(file, ",");
+            for (const auto& index : index_) {
+                if (index.first == column) fprintf(file, "%.17g", index.second);
+            }
+        }
+        ok = fprintf(file, "\n") > 0 && ok;
+    }
+    return ok;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+#include "skiplist.h"
+
+#define QUEUE_SIZE 1024 // Slots of each shard's SPSC queue (power of two)
+#define REBALANCE_INTERVAL 65536 // Inserts routed between rebalance checks
+#define REBALANCE_RATIO 2 // A shard above REBALANCE_RATIO x average is split
+
+// Single-producer single-consumer ring between the router and one shard worker
+template<typename T>
+class SpscQueue {
+   public:
+    SpscQueue() : head_(0), tail_(0) {}
+
+    bool Push(const T& item) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == QUEUE_SIZE) return false;
+        slots_[tail & (QUEUE_SIZE - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& item) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+        item = slots_[head & (QUEUE_SIZE - 1)];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+   private:
+    alignas(64) std::atomic<size_t> head_; // Consumer position
+    alignas(64) std::atomic<size_t> tail_; // Producer position
+    T slots_[QUEUE_SIZE];
+};
+
+// Shared-nothing wrapper over range-partitioned SkipList shards. Each shard is
+// owned by one worker thread pinned to a core and fed through an SPSC queue, so
+// every SkipList runs its single-threaded code paths. Operations must be issued
+// from one router thread.
+template<typename Key>
+class ShardedSkipList {
+   public:
+    ShardedSkipList(int shards, const Key& max_key); // Even initial ranges over [0, max_key]
+    ~ShardedSkipList();
+
+    void Insert(const Key& key); // Asynchronous, applied in order per shard
+    bool Contains(const Key& key);
+    size_t Scan(const Key& key, size_t scan_num, Key* out); // Stitched across shards in key order
+
+    void Sync(); // Wait until every queued operation is applied
+    bool Rebalance(); // Split the largest shard at its median key if it is too large
+
+    inline int print_shards() { return shards_.size(); }
+
+   private:
+    enum OpType { kInsert, kContains, kScan, kBarrier };
+
+    struct Op {
+        OpType type;
+        Key key;
+        size_t n;
+        Key* out;
+        size_t* result;
+        std::atomic<bool>* done;
+    };
+
+    struct Shard {
+        SkipList<Key> sl;
+        Key lo; // Smallest key routed to this shard
+        size_t routed; // Inserts routed, used to find oversized shards
+        SpscQueue<Op> queue;
+        std::atomic<bool> stop;
+        std::thread worker;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards_; // Sorted by lo
+    size_t routed_total_;
+
+    int Route(const Key& key) const;
+    void Start(Shard* shard, int core);
+    void Push(Shard* shard, const Op& op);
+    void Wait(std::atomic<bool>& done);
+    static void Run(Shard* shard);
+};
+
+template<typename Key>
+ShardedSkipList<Key>::ShardedSkipList(int shards, const Key& max_key) : routed_total_(0) {
+    for (int i = 0; i < shards; i++) {
+        std::unique_ptr<Shard> shard(new Shard());
+        shard->lo = (i == 0) ? Key() : (Key)(max_key / shards * i);
+        shard->routed = 0;
+        shard->stop = false;
+        Start(shard.get(), i);
+        shards_.push_back(std::move(shard));
+    }
+}
+
+template<typename Key>
+ShardedSkipList<Key>::~ShardedSkipList() {
+    for (auto& shard : shards_) {
+        shard->stop = true;
+        shard->worker.join();
+    }
+}
+
+template<typename Key>
+void ShardedSkipList<Key>::Start(Shard* shard, int core) {
+    shard->worker = std::thread(Run, shard);
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(shard->worker.native_handle(), sizeof(cpu_set_t), &set);
+}
+
+template<typename Key>
+void ShardedSkipList<Key>::Run(Shard* shard) {
+    Op op;
+    while (true) {
+        if (!shard->queue.Pop(op)) {
+            if (shard->stop) break;
+            std::this_thread::yield();
+            continue;
+        }
+        switch (op.type) {
+            case kInsert: shard->sl.Insert_usplit(op.key); break;
+            case kContains: *op.result = shard->sl.Contains(op.key); break;
+            case kScan: *op.result = shard->sl.Scan(op.key, op.n, op.out); break;
+            case kBarrier: break;
+        }
+        if (op.done != nullptr) op.done->store(true, std::memory_order_release);
+    }
+}
+
+template<typename Key>
+int ShardedSkipList<Key>::Route(const Key& key) const {
+    int lo = 0, hi = shards_.size() - 1;
+    while (lo < hi) { // Last shard whose lower bound is <= key
+        int mid = (lo + hi + 1) / 2;
+        if (compare_(shards_[mid]->lo, key) <= 0) lo = mid; else hi = mid - 1;
+    }
+    return lo;
+}
+
+template<typename Key>
+void ShardedSkipList<Key>::Push(Shard* shard, const Op& op) {
+    while (!shard->queue.Push(op)) {
+        std::this_thread::yield();
+    }
+}
+
+template<typename Key>
+void ShardedSkipList<Key>::Wait(std::atomic<bool>& done) {
+    while (!done.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+template<typename Key>
+void ShardedSkipList<Key>::Insert(const Key& key) {
+    Shard* shard = shards_[Route(key)].get();
+    Push(shard, Op{kInsert, key, 0, nullptr, nullptr, nullptr});
+    shard->routed++;
+    if (++routed_total_ % REBALANCE_INTERVAL == 0) {
+        Rebalance();
+    }
+}
+
+template<typename Key>
+bool ShardedSkipList<Key>::Contains(const Key& key) {
+    std::atomic<bool> done(false);
+    size_t result = 0;
+    Push(shards_[Route(key)].get(), Op{kContains, key, 0, nullptr, &result, &done});
+    Wait(done);
+    return result != 0;
+}
+
+template<typename Key>
+size_t ShardedSkipList<Key>::Scan(const Key& key, size_t scan_num, Key* out) {
+    size_t n = 0;
+    Key from = key;
+    for (size_t i = Route(key); i < shards_.size() && n < scan_num; i++) {
+        std::atomic<bool> done(false);
+        size_t result = 0;
+        Push(shards_[i].get(), Op{kScan, from, scan_num - n, out + n, &result, &done});
+        Wait(done);
+        n += result;
+        if (i + 1 < shards_.size()) from = shards_[i + 1]->lo;
+    }
+    return n;
+}
+
+template<typename Key>
+void ShardedSkipList<Key>::Sync() {
+    std::vector<std::atomic<bool>> done(shards_.size());
+    for (size_t i = 0; i < shards_.size(); i++) {
+        done[i] = false;
+        Push(shards_[i].get(), Op{kBarrier, Key(), 0, nullptr, nullptr, &done[i]});
+    }
+    for (auto& d : done) Wait(d);
+}
+
+// After Sync every queue is empty, so the router may touch a shard's SkipList
+// directly while its worker only polls the queue.
+template<typename Key>
+bool ShardedSkipList<Key>::Rebalance() {
+    size_t largest = 0;
+    for (size_t i = 1; i < shards_.size(); i++) {
+        if (shards_[i]->routed > shards_[largest]->routed) largest = i;
+    }
+    Shard* shard = shards_[largest].get();
+    if (shard->routed * shards_.size() <= REBALANCE_RATIO * routed_total_) return false;
+
+    Sync();
+    std::vector<Key> keys(shard->routed);
+    size_t n = shard->sl.Scan(shard->lo, keys.size(), keys.data());
+    if (n < 2) return false;
+
+    std::unique_ptr<Shard> right(new Shard());
+    right->lo = keys[n / 2];
+    right->routed = shard->routed / 2;
+    right->stop = false;
+    shard->routed -= right->routed;
+    shard->sl.SplitAt(right->lo, right->sl);
+
+    Start(right.get(), shards_.size());
+    shards_.insert(shards_.begin() + largest + 1, std::move(right));
+    return true;
+}
@@ -1,6 +1,9 @@
+#pragma once
+
 #include <stdlib.h>
 #include <cstdint>
 #include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <cstring>
 #include <xmmintrin.h>
@@ -9,13 +12,101 @@
 #include <smmintrin.h>
 #include <bit>
 #include <functional>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 #define ARR_SIZE 64
 #define MAXHEIGHT 50
 
 #define PREFETCH_DISTANCE 8
 
+// Adaptive split: insertion skew is an EWMA in [0, SKEW_SCALE] of how often a
+// key lands past the previously inserted one. Above SKEW_THRESHOLD, a full
+// leaf is split at the insert position instead of at ARR_SIZE/2.
+#define SKEW_SCALE 1024
+#define SKEW_THRESHOLD 896
+
+// Lazy insertion: leaves split by Insert_lazy wait here until their upper-level
+// entries are inserted. Lookups reach them through forward links meanwhile.
+#define PENDING_SIZE 16
+
+// Compaction: adjacent siblings are merged while the result stays within
+// COMPACT_FILL entries, leaving headroom for later inserts, and the siblings
+// under a parent are packed up to COMPACT_FILL when that frees more nodes.
+#define COMPACT_FILL (ARR_SIZE * 3 / 4)
+
+// Batch insertion: forward links followed before falling back to a descent
+#define BATCH_HOPS 4
+
+// Bulk load: entries per node built bottom-up
+#define BULK_FILL ARR_SIZE
+
+// Memory accounting: buckets of the node fill histogram, ARR_SIZE/FILL_BUCKETS entries each
+#define FILL_BUCKETS 8
+
+// Instrumentation: building with -DDASL_STATS (make STATS=1) counts what the
+// hot paths did in per-thread OpStats. Otherwise STAT() expands to nothing.
+#define STAT_BUCKETS 65 // log2 histograms, bucket b counts values of bit width b
+
+#ifdef DASL_STATS
+#define STAT(stmt) do { stmt; } while (0)
+#else
+#define STAT(stmt) do {} while (0)
+#endif
+
+struct OpStats {
+    uint64_t inserts;         // Insert_usplit/esplit/asplit/lazy, batch keys that split included
+    uint64_t lookups;         // Contains
+    uint64_t scans;
+    uint64_t levels;          // Upper levels traversed by descents
+    uint64_t nodes;           // Nodes visited by descents, forward hops included
+    uint64_t linear_searches; // In-node searches by the linear (SIMD) kernels
+    uint64_t binary_searches; // In-node searches by the binary kernels
+    uint64_t memmove_bytes;
+    uint64_t shifts;          // Same events as print_shift, over every list of the thread
+    uint64_t splits;          // Same events as print_split_cnt
+    uint64_t propagations;    // Upper levels an insert restructured
+    uint64_t nodes_hist[STAT_BUCKETS];       // Nodes visited per operation
+    uint64_t memmove_hist[STAT_BUCKETS];     // Bytes memmoved per insert
+    uint64_t propagation_hist[STAT_BUCKETS]; // Upper levels restructured per insert
+};
+
+thread_local OpStats op_stats;
+
+inline int StatBucket(uint64_t value) {
+    return (value == 0) ? 0 : 64 - __builtin_clzll(value);
+}
+
+inline OpStats StatsSnapshot() { return op_stats; } // Counters of the calling thread
+inline void ResetStats() { op_stats = OpStats(); }
+inline void MergeStats(OpStats& into, const OpStats& from) { // For summing the snapshots of several threads
+    uint64_t* a = reinterpret_cast<uint64_t*>(&into);
+    const uint64_t* b = reinterpret_cast<const uint64_t*>(&from);
+    for (size_t i = 0; i < sizeof(OpStats) / sizeof(uint64_t); i++) a[i] += b[i];
+}
+
+#ifdef DASL_STATS
+// Files the deltas of one operation into the histograms when it returns
+struct OpScope {
+    uint64_t nodes, bytes, propagations;
+    bool insert;
+    OpScope(bool insert) : nodes(op_stats.nodes), bytes(op_stats.memmove_bytes), propagations(op_stats.propagations), insert(insert) {}
+    ~OpScope() {
+        op_stats.nodes_hist[StatBucket(op_stats.nodes - nodes)]++;
+        if (!insert) return;
+        op_stats.memmove_hist[StatBucket(op_stats.memmove_bytes - bytes)]++;
+        op_stats.propagation_hist[StatBucket(op_stats.propagations - propagations)]++;
+    }
+};
+#define STAT_OP(insert) OpScope stat_op_(insert)
+#else
+#define STAT_OP(insert) do {} while (0)
+#endif
+
 typedef uint64_t Key; // Key is an 8-byte integer
+typedef uint64_t Value; // Value is an 8-byte integer, Value() for keys inserted without one
 
 typedef std::chrono::high_resolution_clock Clock;
 
@@ -29,18 +120,62 @@ int compare_(const Key& a, const Key& b) {
     }
 }
 
+// Told of every insert, lookup, scan and range delete issued against a SkipList
+// it is set on, e.g. to capture a trace of real traffic. Not called when none
+// is set. Bulk loads are told as one insert per key.
+template<typename Key>
+class OpRecorder {
+   public:
+    virtual ~OpRecorder() {}
+    virtual void OnInsert(const Key& key) = 0;
+    virtual void OnLookup(const Key& key) = 0;
+    virtual void OnScan(const Key& key, size_t scan_num) = 0;
+    virtual void OnDeleteRange(const Key& lo, const Key& hi) = 0;
+    virtual void OnDeleteFrom(const Key& lo) = 0;
+};
+
 template<typename Key>
 class SkipList {
    private:
     struct Node;
 
    public:
+    class View;
+
+    struct Summary { // Aggregate over the values of the keys in a range
+        size_t count;
+        Value sum; // Wraps around like Value arithmetic does
+        Value min;
+        Value max; // min and max are Value() when count is 0
+    };
+
+    struct MemoryUsage {
+        int height;
+        size_t nodes[MAXHEIGHT];      // Nodes per level
+        size_t bytes[MAXHEIGHT];      // Allocated bytes per level, subtree counts, summaries and values included
+        size_t key_bytes[MAXHEIGHT];  // Bytes of live keys (entries on upper levels)
+        size_t fill[MAXHEIGHT][FILL_BUCKETS]; // Nodes per level whose N_key falls in each bucket
+        size_t head_bytes;            // Sentinel heads
+        size_t snapshot_bytes;        // Copies and unlinked nodes kept for live snapshots
+        size_t total_bytes;
+    };
+
     SkipList();
+    ~SkipList();
+    SkipList(const SkipList&) = delete;
+    SkipList& operator=(const SkipList&) = delete;
 
     // DASL's insertion functions
     void Insert_usplit(const Key& key); // Code for insertion with uneven-split
     void Insert_esplit(const Key& key); // Code for insertion with even-split
+    void Insert_asplit(const Key& key); // Code for insertion with adaptive-split
+    void Insert_lazy(const Key& key); // Code for insertion with deferred upper-level maintenance
+    void InsertBatch(Key* keys, size_t n); // Sorts keys in place, then merges each run into its leaf
+    void ParallelBulkLoad(Key* keys, size_t n, int threads); // Sorts keys in place, then builds bottom-up
+    void Put(const Key& key, const Value& value); // Insert_usplit carrying a value, or update the value of key
     
+    // Breakdown variants. Insert_Array builds upper levels without subtree counts, so
+    // order statistics scan the leaves once it was used, and it takes no list with values.
     void Insert_Raise(const Key& key);
     void Insert_Search(const Key& key);
     void Insert_Array(const Key& key);
@@ -50,178 +185,1551 @@ class SkipList {
     // DASL's lookup functions
     bool Contains(const Key& key) const; 
     bool Contains_Raise(const Key& key) const;
+    bool Get(const Key& key, Value* value) const; // Value of key, false if key is absent
 
     // DASL's Scan functions
     Key Scan(const Key& key, const int scan_num);
+    size_t Scan(const Key& key, size_t scan_num, Key* out) const; // Copy up to scan_num keys >= key into out
+
+    // DASL's order-statistic functions (pending leaves are indexed first)
+    size_t Size(); // Number of keys
+    size_t Rank(const Key& key); // Number of keys < key
+    Key Select(size_t i); // i-th smallest key (from 0), Key() if i >= Size()
+    size_t CountRange(const Key& lo, const Key& hi); // Number of keys in [lo, hi)
+    Summary Aggregate(const Key& lo, const Key& hi); // Count of keys in [lo, hi) and sum, min and max of their values
+
+    // DASL's maintenance functions
+    void DrainPending(int budget); // Index up to budget pending leaves (external lock needed if run on another thread)
+    int Compact(int budget); // Merge underfull siblings under up to budget parents, returns freed nodes
+    void Clear(); // Free every node, leaving an empty list
+    void SplitAt(const Key& key, SkipList<Key>& right); // Move keys >= key into the empty list right
+    size_t DeleteRange(const Key& lo, const Key& hi); // Remove keys in [lo, hi), returns the number removed
+    size_t DeleteFrom(const Key& lo); // Remove keys >= lo, returns the number removed
+
+    // DASL's snapshot functions
+    const View* Snapshot(); // Read-only point-in-time view, valid until released
+    void ReleaseSnapshot(const View* view);
 
     // DASL's profiling functions
+    MemoryUsage MemoryStats() const; // Reads the upper levels only, leaves are accounted through their counts
     void Array_utilization();
     void Print() const;
     inline int print_shift() { return shift_count; }
     inline int print_split_cnt() { return split_count; }
     inline int print_height() { return max_height_; }
+    inline int print_skew() { return skew_; }
+    inline int print_pending() { return pending_count_; }
+
+    // Operation recording, nullptr to stop
+    inline void SetRecorder(OpRecorder<Key>* recorder) { recorder_ = recorder; }
 
    private:
     int kMaxHeight_;
     Node* head_[MAXHEIGHT];
     int max_height_;
 
-    int shift_count;
-    int split_count;
+    int shift_count;
+    int split_count;
+
+    int skew_;    // Insertion skew used by the adaptive split
+    Key last_key_; // Previously inserted key
+
+    Node* pending_[PENDING_SIZE]; // Ring of split leaves not indexed yet
+    int pending_head_;
+    int pending_count_;
+    int deferred_count_;
+
+    int compact_level_;    // Level whose nodes Compact is merging
+    Node* compact_cursor_; // Parent at compact_level_+1 to resume from
+
+    Node* tail_[MAXHEIGHT]; // Last node of each level (rightmost spine)
+
+    int version_;          // Bumped by every Snapshot, stamped on new and copied nodes
+    int newest_snapshot_;  // Version of the newest live snapshot, 0 if none
+    std::vector<View*> snapshots_;
+    // Unlinked nodes still visible to a snapshot, each with the version_ it was
+    // unlinked at; only snapshots older than that can reach it
+    std::vector<std::pair<int, Node*>> retired_;
+
+    OpRecorder<Key>* recorder_;
+
+    size_t value_nodes_; // Leaves with a value array
+    bool stale_counts_;  // Set by Insert_Array, whose upper levels carry no subtree counts
+
+    inline int GetMaxHeight() const {
+        return max_height_;
+    }
+
+    // Every shift, split and memmove also feeds the per-thread OpStats
+    inline void CountShift() {
+        shift_count++;
+        STAT(op_stats.shifts++);
+    }
+    inline void CountSplit() {
+        split_count++;
+        STAT(op_stats.splits++);
+    }
+    static inline void Memmove(void* dst, const void* src, size_t n) {
+        std::memmove(dst, src, n);
+        STAT(op_stats.memmove_bytes += n);
+    }
+
+    // Nodes are only ever linked after existing ones, so catching up from the
+    // last known tail is amortized O(1) per created node.
+    inline void SyncTail() {
+        for (int i = 0; i < GetMaxHeight(); i++) {
+            while (tail_[i]->forward != nullptr) tail_[i] = tail_[i]->forward;
+        }
+    }
+
+    inline int randomLevel() {
+        int level = 0;
+        while (std::rand() % 4 == 0 && level < MAXHEIGHT) { level++; }
+        if (level+1 > max_height_) { max_height_ = level+1; }
+        return level;
+    }
+
+    Node* NewNode(const Key& key); // Make a new node with key
+
+    // Copy-on-write for live snapshots: a node must be preserved before its
+    // first write after a snapshot that can see it
+    inline void Preserve(Node* x) {
+        if (x->version <= newest_snapshot_) CopyOnWrite(x);
+    }
+    void CopyOnWrite(Node* x);
+    void PreserveSpine(Node* prev_[], int level);
+    void Retire(Node* x);
+    void FreeRetired();
+
+    // Subtree key counts and value summaries of upper-level entries: counts[i]
+    // is the number of keys under next[i] and summaries[i] the sum, minimum and
+    // maximum of their values. Insert paths mark the spine before restructuring
+    // and recount only what changed afterwards.
+    struct ValueSummary {
+        Value sum;
+        Value min;
+        Value max;
+    };
+    struct SpineMark {
+        Node* node;  // prev_[l], possibly the head
+        Node* to;    // Node after the marked nodes before the insert
+        int nodes;   // Marked nodes before the insert (0 or 1, up to 2 by MarkSpill)
+        int n_key;   // N_key of the first before the insert
+        int next_n_key; // N_key of the second, if any
+        int slot;    // Entry of the spine node found by the descent, -1 if unknown
+    };
+    inline uint32_t* Counts(Node* x) {
+        if (x->counts == nullptr) {
+            x->counts = new uint32_t[ARR_SIZE]();
+            x->summaries = new ValueSummary[ARR_SIZE]();
+        }
+        return x->counts;
+    }
+    inline ValueSummary* Summaries(Node* x) {
+        Counts(x);
+        return x->summaries;
+    }
+    static inline ValueSummary NoValues() { return {Value(), std::numeric_limits<Value>::max(), std::numeric_limits<Value>::min()}; }
+    static inline ValueSummary OneValue(const Value& value) { return {value, value, value}; }
+    static inline void Fold(ValueSummary& summary, const ValueSummary& other) {
+        summary.sum += other.sum;
+        summary.min = std::min(summary.min, other.min);
+        summary.max = std::max(summary.max, other.max);
+    }
+    size_t SubtreeSize(Node* x, int level) const;
+    ValueSummary SubtreeValues(Node* x, int level) const;
+    void FoldRange(Node* x, int level, const Key& lo, const Key& hi, const Key* end, Summary* summary, ValueSummary* values);
+    inline Node* FirstCovered(int level) const { // First node of level under an upper-level entry
+        return (level + 1 < GetMaxHeight() && head_[level+1]->forward != nullptr) ? head_[level+1]->forward->next[0] : nullptr;
+    }
+    void Recount(Node* x, int level);
+    int MarkSpine(Node* prev_[], const int slot_[], SpineMark mark[]);
+    void RecountSpine(const SpineMark mark[], int levels, const Value& value);
+    int MarkSpill(Node* prev_[], SpineMark mark[]); // Also marks the node after the spine node
+    void RecountSpill(const SpineMark mark[], int levels);
+    void AdjustCounts(Node* leaf, int delta, const ValueSummary& added);
+    void RefreshPath(Node* leaf); // Recompute the summaries above leaf after a value changed in place
+
+    // Leaf values live beside keys[] and are allocated by the first value other
+    // than Value(), so lists of keys only never touch them. Inserts save the
+    // values of the leaves they restructure and put them back by key afterwards,
+    // rather than following every shift and split of the keys.
+    struct LeafValues {
+        int n_key; // 0 when the leaves carry no values
+        Key keys[2 * ARR_SIZE]; // Two leaves when marked by MarkSpill
+        Value values[2 * ARR_SIZE];
+    };
+    inline Value* Values(Node* x) {
+        if (x->values == nullptr) {
+            x->values = new Value[ARR_SIZE]();
+            value_nodes_++;
+        }
+        return x->values;
+    }
+    inline void SetValue(Node* x, int i, const Value& value) {
+        if (x->values == nullptr && value == Value()) return;
+        Values(x)[i] = value;
+    }
+    inline void CopyValues(Node* dst, int d, Node* src, int s, int n) { // Same move as the keys beside them
+        if (src->values != nullptr) Memmove(&Values(dst)[d], &src->values[s], n * sizeof(Value));
+        else if (dst->values != nullptr) std::fill(dst->values + d, dst->values + d + n, Value());
+    }
+    void SaveValues(const SpineMark& mark, LeafValues* saved) const;
+    void RestoreValues(const SpineMark& mark, const LeafValues& saved, const Key& key, const Value& value);
+
+    // Shared body of Insert_usplit, Insert_asplit, Insert_lazy and Put
+    void InsertImpl(const Key& key, const Value& value, bool adaptive, bool lazy);
+    void InsertLevels(Node* prev_[], const int slot_[], const Key& key, const Value& value, int level, bool adaptive, bool lazy);
+    void DeferIndex(Node* node);
+    void MergeInto(Node* parent, int idx, int level);
+    void ShiftInto(Node* parent, int idx, int level, int n);
+    int PackFrees(Node* parent, bool shift) const;
+    Node* FindLeaf(const Key& key) const;
+
+    // Bottom-up construction helpers for ParallelBulkLoad
+    Node* BuildLeaves(const Key* keys, const Value* values, size_t lo, size_t hi, Node** last, size_t* count);
+    Node* BuildLevel(Node* first, size_t n_child, int level, Node** last, size_t* count);
+    void BuildFrom(const Key* keys, const Value* values, size_t n, int threads); // Sorted keys into an empty list
+
+    // Range deletion helpers: drop the entries in [lo, hi), or >= lo when not bounded
+    size_t DeleteKeys(const Key& lo, const Key& hi, bool bounded);
+    int TrimNode(Node* x, int level, const Key& lo, const Key& hi, bool bounded, Node* kept);
+
+    // Append fast path for keys past the current maximum
+    int AppendFastPath(const Key& key, const Value& value, Node* prev_[]);
+
+    // Intra-node search with linear search and SIMD
+    int findMaxLessOrEqualLinear(Key arr[], Key target, int size) const;
+    int findMaxLessOrEqualLinearSIMD(Key arr[], Key target, int size) const;
+
+    // Intra-node search with branchless binary search
+    // findMaxLessOrEqual == findMaxLessOrEqualBinary
+    int findMaxLessOrEqual(Key arr[], Key target) const; 
+    int findMaxLessOrEqualBinary(Key arr[], Key target) const; 
+};
+
+
+template<typename Key>
+struct SkipList<Key>::Node {
+    Key keys[ARR_SIZE]; // keys[0] = leader key of current node
+    Node* forward;
+    Node* next[ARR_SIZE];
+    int N_key;
+    int version; // Snapshots taken at or after this version see the node as it is
+    uint32_t* counts; // Subtree key counts of next[], allocated on upper levels only
+    ValueSummary* summaries; // Subtree value summaries of next[], allocated along with counts
+    Value* values; // Values of keys[], allocated on leaves only
+
+    Node(Key key) : N_key(1), version(0), counts(nullptr), summaries(nullptr), values(nullptr) {
+        this->forward = nullptr;
+        for(int i = 0; i < ARR_SIZE; i++) {
+            keys[i] = 0;
+            next[i] = nullptr;
+        }
+        this->keys[0] = key;
+    }
+    ~Node() {
+        delete[] counts;
+        delete[] summaries;
+        delete[] values;
+    }
+};
+
+template<typename Key>
+typename SkipList<Key>::Node*
+SkipList<Key>::NewNode(const Key& key) {
+    Node* node = new Node(key);
+    node->version = version_;
+    return node;
+}
+
+template<typename Key>
+SkipList<Key>::SkipList() {
+    kMaxHeight_ = MAXHEIGHT;
+    max_height_ = 1;
+    shift_count = 0;
+    split_count = 0;
+    skew_ = 0;
+    last_key_ = Key();
+    pending_head_ = 0;
+    pending_count_ = 0;
+    deferred_count_ = 0;
+    compact_level_ = 0;
+    compact_cursor_ = nullptr;
+    version_ = 1;
+    newest_snapshot_ = 0;
+    recorder_ = nullptr;
+    value_nodes_ = 0;
+    stale_counts_ = false;
+
+    for(int i = 0; i < kMaxHeight_; i++) {
+        head_[i] = NewNode(Key());  
+        tail_[i] = head_[i];
+    }
+}
+
+template<typename Key>
+SkipList<Key>::~SkipList() {
+    recorder_ = nullptr; // Freeing the nodes is not a delete of the keys
+    while (!snapshots_.empty()) {
+        ReleaseSnapshot(snapshots_.back());
+    }
+    Clear();
+    for(int i = 0; i < kMaxHeight_; i++) {
+        delete head_[i];
+    }
+}
+
+template<typename Key>
+void SkipList<Key>::Clear() {
+    for (int i = 0; i < kMaxHeight_; i++) {
+        Node* x = head_[i]->forward;
+        while (x != nullptr) {
+            Node* next = x->forward;
+            Retire(x);
+            x = next;
+        }
+        head_[i]->forward = nullptr;
+        tail_[i] = head_[i];
+    }
+    max_height_ = 1;
+    pending_head_ = 0;
+    pending_count_ = 0;
+    compact_level_ = 0;
+    compact_cursor_ = nullptr;
+    stale_counts_ = false;
+}
+
+// Rebuilds both halves bottom-up, so it costs a pass over all keys
+template<typename Key>
+void SkipList<Key>::SplitAt(const Key& key, SkipList<Key>& right) {
+    if (recorder_ != nullptr) recorder_->OnDeleteFrom(key);
+    std::vector<Key> lower, upper;
+    std::vector<Value> lower_values, upper_values;
+    for (Node* x = head_[0]->forward; x != nullptr; x = x->forward) {
+        for (int i = 0; i < x->N_key; i++) {
+            Value value = (x->values != nullptr) ? x->values[i] : Value();
+            if (compare_(x->keys[i], key) < 0) {
+                lower.push_back(x->keys[i]);
+                lower_values.push_back(value);
+            } else {
+                upper.push_back(x->keys[i]);
+                upper_values.push_back(value);
+            }
+        }
+    }
+    bool valued = value_nodes_ > 0;
+    Clear();
+    BuildFrom(lower.data(), valued ? lower_values.data() : nullptr, lower.size(), 1);
+    right.BuildFrom(upper.data(), valued ? upper_values.data() : nullptr, upper.size(), 1);
+    if (right.recorder_ != nullptr) {
+        for (const Key& k : upper) right.recorder_->OnInsert(k);
+    }
+}
+
+// Drop the entries of x in [lo, hi), or every entry from lo when not bounded,
+// and return how many were dropped. On upper levels the last entry in the
+// range is kept when its child is kept, the child that survived the level
+// below with a leader moved past hi, and takes the new leader as its key.
+template<typename Key>
+int SkipList<Key>::TrimNode(Node* x, int level, const Key& lo, const Key& hi, bool bounded, Node* kept) {
+    int a = std::lower_bound(x->keys, x->keys + x->N_key, lo) - x->keys;
+    int b = bounded ? std::lower_bound(x->keys, x->keys + x->N_key, hi) - x->keys : x->N_key;
+    if (level > 0 && b > a && x->next[b-1] == kept) {
+        x->keys[b-1] = kept->keys[0];
+        b--;
+    }
+    int dropped = b - a;
+    if (dropped == 0) return 0;
+
+    int n_key = x->N_key;
+    Memmove(&x->keys[a], &x->keys[b], (n_key - b) * sizeof(Key));
+    std::fill(x->keys + n_key - dropped, x->keys + n_key, 0);
+    if (level == 0) {
+        CopyValues(x, a, x, b, n_key - b);
+    } else {
+        Memmove(&x->next[a], &x->next[b], (n_key - b) * sizeof(x->next[0]));
+        std::fill(x->next + n_key - dropped, x->next + n_key, nullptr);
+        uint32_t* counts = Counts(x);
+        Memmove(&counts[a], &counts[b], (n_key - b) * sizeof(uint32_t));
+        Memmove(&x->summaries[a], &x->summaries[b], (n_key - b) * sizeof(ValueSummary));
+        std::fill(counts + n_key - dropped, counts + n_key, 0);
+        std::fill(x->summaries + n_key - dropped, x->summaries + n_key, ValueSummary());
+    }
+    CountShift(); // Signal.Jin
+    x->N_key -= dropped;
+    return dropped;
+}
+
+template<typename Key>
+size_t SkipList<Key>::DeleteRange(const Key& lo, const Key& hi) {
+    if (recorder_ != nullptr) recorder_->OnDeleteRange(lo, hi);
+    if (compare_(lo, hi) >= 0) return 0;
+    return DeleteKeys(lo, hi, true);
+}
+
+// Unlike DeleteRange(lo, max), also drops a key equal to the largest Key
+template<typename Key>
+size_t SkipList<Key>::DeleteFrom(const Key& lo) {
+    if (recorder_ != nullptr) recorder_->OnDeleteFrom(lo);
+    return DeleteKeys(lo, Key(), false);
+}
+
+// Works one level at a time from the leaves up. On each level the nodes whose
+// leader falls in [lo, hi), or from lo on when not bounded, are contiguous and all of them but the last lose
+// every entry, so they are unlinked whole; only the node in front of the range
+// and that last node are trimmed. A node that keeps entries keeps its parent
+// entry, which is moved to its new leader, and the counts and summaries above are
+// refreshed for these two boundary nodes only.
+template<typename Key>
+size_t SkipList<Key>::DeleteKeys(const Key& lo, const Key& hi, bool bounded) {
+    DrainPending(PENDING_SIZE);
+
+    // Last node with a leader below lo on each level, or the head
+    Node* from[MAXHEIGHT];
+    int height = GetMaxHeight();
+    Node* x = head_[height - 1];
+    for (int l = height - 1; l >= 0; l--) {
+        if (l < height - 1) {
+            if (x == head_[l+1]) {
+                x = head_[l];
+            } else {
+                x = x->next[(std::lower_bound(x->keys, x->keys + x->N_key, lo) - x->keys) - 1];
+            }
+        }
+        while (x->forward != nullptr && compare_(x->forward->keys[0], lo) < 0) x = x->forward;
+        from[l] = x;
+    }
+
+    size_t removed = 0;
+    Node* kept = nullptr;    // Node of the level below kept with a leader moved past hi
+    Node* changed = nullptr; // Node of the level below in front of the range, if trimmed
+    std::vector<Node*> unlinked;
+    for (int l = 0; l < height; l++) {
+        Node* p = from[l];
+        Node* next_kept = nullptr;
+        Node* next_changed = nullptr;
+
+        if (p != head_[l]) {
+            Preserve(p);
+            int dropped = TrimNode(p, l, lo, hi, bounded, kept);
+            if (l == 0) removed += dropped;
+            if (dropped > 0 || l > 0) next_changed = p;
+        }
+        Node* q = p->forward;
+        while (q != nullptr && (!bounded || compare_(q->keys[0], hi) < 0)) {
+            Preserve(q);
+            int dropped = TrimNode(q, l, lo, hi, bounded, kept);
+            if (l == 0) removed += dropped;
+            if (q->N_key > 0) { // Only the last node of the range can keep entries
+                next_kept = q;
+                break;
+            }
+            if (p != head_[l]) Preserve(p);
+            p->forward = q->forward;
+            if (tail_[l] == q) tail_[l] = p;
+            if (compact_cursor_ == q) compact_cursor_ = nullptr;
+            unlinked.push_back(q);
+            q = p->forward;
+        }
+
+        // Refresh the entries over the boundary nodes of the level below
+        if (l > 0 && (changed != nullptr || kept != nullptr)) {
+            for (Node* y : {from[l], next_kept}) {
+                if (y == nullptr || y == head_[l]) continue;
+                for (int i = 0; i < y->N_key; i++) {
+                    if (y->next[i] == changed || y->next[i] == kept) {
+                        Counts(y)[i] = SubtreeSize(y->next[i], l - 1);
+                        y->summaries[i] = SubtreeValues(y->next[i], l - 1);
+                    }
+                }
+            }
+        }
+        kept = next_kept;
+        changed = next_changed;
+    }
+
+    // Unlinked nodes are released only now, as entries above still pointed to them
+    for (Node* y : unlinked) Retire(y);
+    while (max_height_ > 1 && head_[max_height_ - 1]->forward == nullptr) {
+        max_height_--;
+    }
+    compact_level_ = 0;
+    compact_cursor_ = nullptr;
+    return removed;
+}
+
+// Point-in-time view of a SkipList. A node written after the snapshot is read
+// from the copy taken before its first write, and nodes created after the
+// snapshot are unreachable from it, so writers never disturb an open view.
+// Like the list itself, a view needs external synchronization across threads.
+template<typename Key>
+class SkipList<Key>::View {
+   public:
+    bool Contains(const Key& key) const;
+    size_t Scan(const Key& key, size_t scan_num, Key* out) const; // Copy up to scan_num keys >= key into out
+
+    inline size_t print_copies() const { return copies_.size(); }
+
+   private:
+    friend class SkipList<Key>;
+
+    const SkipList<Key>* list_;
+    int version_;
+    int height_;
+    Node* first_[MAXHEIGHT]; // head_[i]->forward when the snapshot was taken
+    std::unordered_map<Node*, Node*> copies_; // Node written after the snapshot -> its old content
+
+    inline Node* Read(Node* x) const {
+        auto it = copies_.find(x);
+        return (it == copies_.end()) ? x : it->second;
+    }
+    Node* FindLeaf(const Key& key) const;
+};
+
+template<typename Key>
+const typename SkipList<Key>::View*
+SkipList<Key>::Snapshot() {
+    View* view = new View();
+    view->list_ = this;
+    view->version_ = version_++;
+    view->height_ = GetMaxHeight();
+    for (int i = 0; i < kMaxHeight_; i++) {
+        view->first_[i] = head_[i]->forward;
+    }
+    snapshots_.push_back(view);
+    newest_snapshot_ = view->version_;
+    return view;
+}
+
+template<typename Key>
+void SkipList<Key>::ReleaseSnapshot(const View* view) {
+    auto it = std::find(snapshots_.begin(), snapshots_.end(), view);
+    if (it == snapshots_.end()) return;
+    for (auto& copy : (*it)->copies_) {
+        delete copy.second;
+    }
+    delete *it;
+    snapshots_.erase(it);
+
+    newest_snapshot_ = 0;
+    for (View* v : snapshots_) {
+        newest_snapshot_ = std::max(newest_snapshot_, v->version_);
+    }
+    FreeRetired();
+}
+
+// Snapshots are appended in version order, so the first one is the oldest, and
+// nodes are retired in version order, so the freeable ones form a prefix
+template<typename Key>
+void SkipList<Key>::FreeRetired() {
+    size_t n = 0;
+    while (n < retired_.size() &&
+           (snapshots_.empty() || retired_[n].first <= snapshots_.front()->version_)) {
+        delete retired_[n++].second;
+    }
+    retired_.erase(retired_.begin(), retired_.begin() + n);
+}
+
+// Every live snapshot taken since x was last stamped gets its own copy of x
+template<typename Key>
+void SkipList<Key>::CopyOnWrite(Node* x) {
+    for (View* view : snapshots_) {
+        if (view->version_ >= x->version) {
+            Node* copy = new Node(*x);
+            copy->counts = nullptr; // Views never read counts, summaries or values, and x keeps owning them
+            copy->summaries = nullptr;
+            copy->values = nullptr;
+            view->copies_.emplace(x, copy);
+        }
+    }
+    x->version = version_;
+}
+
+// Insert paths write prev_[i] or, when it is a head, prev_[i]->forward on the
+// levels from level up, so both are preserved before the restructuring starts
+template<typename Key>
+void SkipList<Key>::PreserveSpine(Node* prev_[], int level) {
+    if (snapshots_.empty()) return;
+    for (int i = level; i < GetMaxHeight(); i++) {
+        if (prev_[i] == nullptr) continue;
+        if (prev_[i] != head_[i]) Preserve(prev_[i]);
+        if (prev_[i]->forward != nullptr) Preserve(prev_[i]->forward);
+    }
+}
+
+template<typename Key>
+void SkipList<Key>::Retire(Node* x) {
+    if (x->values != nullptr) value_nodes_--;
+    if (snapshots_.empty()) {
+        delete x;
+    } else {
+        retired_.emplace_back(version_, x);
+    }
+}
+
+// Leaf covering key as the snapshot saw it, or nullptr if key is below every leaf.
+// Unlike the live lookup it follows forward links at the leaf level, so leaves
+// that were not indexed yet are found too.
+template<typename Key>
+typename SkipList<Key>::Node*
+SkipList<Key>::View::FindLeaf(const Key& key) const {
+    int height = height_ - 1;
+    Node* x = nullptr; // nullptr stands for the head of the current level
+
+    if (first_[height] != nullptr && compare_(Read(first_[height])->keys[0], key) <= 0) x = first_[height];
+
+    while (height-- > 0) {
+        if (x == nullptr) continue;
+        Node* v = Read(x);
+        int n_key = v->N_key;
+        if (n_key <= ARR_SIZE/2) {
+            x = v->next[list_->findMaxLessOrEqualLinearSIMD(v->keys, key, n_key)];
+        } else {
+            x = v->next[list_->findMaxLessOrEqualBinary(v->keys, key)];
+        }
+    }
+
+    if (x == nullptr) {
+        if (first_[0] == nullptr || compare_(Read(first_[0])->keys[0], key) > 0) return nullptr;
+        x = first_[0];
+    }
+    while (Read(x)->forward != nullptr && compare_(Read(Read(x)->forward)->keys[0], key) <= 0) {
+        x = Read(x)->forward;
+    }
+    return x;
+}
+
+template<typename Key>
+bool SkipList<Key>::View::Contains(const Key& key) const {
+    Node* x = FindLeaf(key);
+    if (x == nullptr) return false;
+    Node* v = Read(x);
+    return std::binary_search(v->keys, v->keys + v->N_key, key);
+}
+
+template<typename Key>
+size_t SkipList<Key>::View::Scan(const Key& key, size_t scan_num, Key* out) const {
+    Node* x = FindLeaf(key);
+    if (x == nullptr) x = first_[0];
+
+    size_t n = 0;
+    int i = (x == nullptr) ? 0 : std::lower_bound(Read(x)->keys, Read(x)->keys + Read(x)->N_key, key) - Read(x)->keys;
+    while (x != nullptr && n < scan_num) {
+        Node* v = Read(x);
+        for (; i < v->N_key && n < scan_num; i++) {
+            out[n++] = v->keys[i];
+        }
+        x = v->forward;
+        i = 0;
+    }
+    return n;
+}
+
+template<typename Key>
+int SkipList<Key>::findMaxLessOrEqualLinear(Key arr[], Key target, int size) const {
+    STAT(op_stats.linear_searches++);
+    for (int i = 0; i < size; ++i) {
+        if (compare_(arr[i], target) > 0) {
+            return i - 1;
+        }
+    }
+    return size - 1;
+}
+
+template<typename Key>
+int SkipList<Key>::findMaxLessOrEqualLinearSIMD(Key arr[], Key target, int size) const {
+    STAT(op_stats.linear_searches++);
+    constexpr int simdWidth = 2;
+    __m128i targetVec = _mm_set1_epi64x(static_cast<uint64_t>(target));
+    int maxIndex = -1;
+    int i = 0;
+    for (; i <= size - simdWidth; i += simdWidth) {
+        __m128i dataVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr[i]));
+        __m128i cmp_gt = _mm_cmpgt_epi64(dataVec, targetVec);
+        __m128i cmp_le = _mm_cmpeq_epi64(cmp_gt, _mm_setzero_si128());
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(cmp_le));
+
+        if (mask != 0) {
+            int bitPos = (mask == 1) ? 0 : 1;
+            maxIndex = i + bitPos;
+        }
+    }
+    for (; i < size; ++i) {
+        if (compare_(arr[i], target) <= 0) {
+            maxIndex = i;
+        }
+    }
+    return maxIndex;
+}
+
+template<typename Key>
+int SkipList<Key>::findMaxLessOrEqualBinary(Key arr[], Key target) const {
+    STAT(op_stats.binary_searches++);
+    Key* begin = arr;
+    std::size_t step = ARR_SIZE;
+    
+    for (step /= 2; step != 0; step /= 2) {
+        Key* probe = begin + step;
+        bool valid = (*probe <= target) && *probe != 0;
+        begin += step * valid;
+    }
+    return begin - arr;
+}
+
+template<typename Key>
+int SkipList<Key>::findMaxLessOrEqual(Key arr[], Key target) const {
+    STAT(op_stats.binary_searches++);
+    Key* begin = arr;
+    std::size_t step = ARR_SIZE;
+    
+    for (step /= 2; step != 0; step /= 2) {
+        Key* probe = begin + step;
+        bool valid = (*probe <= target) && *probe != 0;
+        begin += step * valid;
+    }
+    return begin - arr;
+}
+
+// Returns 1 if the key was appended directly into the tail leaf,
+// 0 if the key is past the maximum but the tail leaf is (about to be) full,
+// in which case prev_ is filled with the rightmost spine, and
+// -1 if the key is not past the maximum (generic insertion is required).
+template<typename Key>
+int SkipList<Key>::AppendFastPath(const Key& key, const Value& value, Node* prev_[]) {
+    SyncTail();
+    Node* leaf = tail_[0];
+    if (leaf == head_[0] || compare_(leaf->keys[leaf->N_key - 1], key) >= 0) {
+        return -1;
+    }
+
+    if (leaf->N_key < ARR_SIZE - 1) { // Leaf keeps a room after append, no restructuring
+        Preserve(leaf);
+        SetValue(leaf, leaf->N_key, value);
+        leaf->keys[leaf->N_key++] = key;
+        // The rightmost entry of each tail node covers the tail below it
+        for (int i = 1; i < GetMaxHeight(); i++) {
+            Node* p = tail_[i];
+            if (p == head_[i] || p->next[p->N_key - 1] != tail_[i-1]) break;
+            Counts(p)[p->N_key - 1]++;
+            Fold(p->summaries[p->N_key - 1], OneValue(value));
+        }
+        return 1;
+    }
+
+    // Appending fills or splits the tail leaf, so propagate along the rightmost spine
+    for (int i = 0; i < GetMaxHeight(); i++) {
+        prev_[i] = tail_[i];
+    }
+    return 0;
+}
+
+template<typename Key>
+void SkipList<Key>::Insert_usplit(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    InsertImpl(key, Value(), false, false);
+}
+
+template<typename Key>
+void SkipList<Key>::Insert_asplit(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    InsertImpl(key, Value(), true, false);
+}
+
+// An existing key gets its value replaced in place, which needs the summaries
+// above its leaf recomputed, and a new key goes through the usplit insertion
+template<typename Key>
+void SkipList<Key>::Put(const Key& key, const Value& value) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    Node* leaf = FindLeaf(key);
+    if (leaf != head_[0]) {
+        int i = std::lower_bound(leaf->keys, leaf->keys + leaf->N_key, key) - leaf->keys;
+        if (i < leaf->N_key && compare_(leaf->keys[i], key) == 0) {
+            if (value == ((leaf->values != nullptr) ? leaf->values[i] : Value())) return;
+            SetValue(leaf, i, value);
+            RefreshPath(leaf);
+            return;
+        }
+    }
+    InsertImpl(key, value, false, false);
+}
+
+template<typename Key>
+void SkipList<Key>::Insert_lazy(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    int deferred = deferred_count_;
+    InsertImpl(key, Value(), false, true);
+    // Inserts that did not split a leaf pay for one pending leaf instead
+    if (deferred_count_ == deferred && pending_count_ > 0) {
+        DrainPending(1);
+    }
+}
+
+template<typename Key>
+void SkipList<Key>::DeferIndex(Node* node) {
+    if (pending_count_ == PENDING_SIZE) {
+        DrainPending(1);
+    }
+    pending_[(pending_head_ + pending_count_) % PENDING_SIZE] = node;
+    pending_count_++;
+    deferred_count_++;
+}
+
+template<typename Key>
+void SkipList<Key>::DrainPending(int budget) {
+    Node* prev_[MAXHEIGHT];
+    while (pending_count_ > 0 && budget-- > 0) {
+        Node* node = pending_[pending_head_];
+        pending_head_ = (pending_head_ + 1) % PENDING_SIZE;
+        pending_count_--;
+
+        // Find the upper-level position of the leader key, then resume the
+        // restructuring the split would have done at level 1
+        std::copy(std::begin(head_), std::end(head_), std::begin(prev_));
+        const Key key = node->keys[0];
+        int height = GetMaxHeight() - 1;
+        Node* x = head_[height];
+
+        if (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) x = x->forward;
+
+        while (height >= 1) {
+            prev_[height--] = x;
+            if (height >= 1) {
+                x = (x == head_[height + 1]) ? head_[height] : x->next[findMaxLessOrEqual(x->keys, key)];
+            }
+        }
+        prev_[0] = node;
+        InsertLevels(prev_, nullptr, key, Value(), 1, false, false);
+    }
+}
+
+// Leaf whose key range covers key, or head_[0] if key is below the indexed leaves
+template<typename Key>
+typename SkipList<Key>::Node*
+SkipList<Key>::FindLeaf(const Key& key) const {
+    int height = GetMaxHeight() - 1;
+    Node* x = head_[height];
+
+    if (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) x = x->forward;
+
+    while (height-- > 0) {
+        STAT(op_stats.nodes++; op_stats.levels++);
+        int n_key = x->N_key;
+        if (n_key <= ARR_SIZE/2) {
+            x = (x == head_[height + 1]) ? head_[height] : x->next[findMaxLessOrEqualLinearSIMD(x->keys, key, n_key)];
+        } else {
+            x = (x == head_[height + 1]) ? head_[height] : x->next[findMaxLessOrEqualBinary(x->keys, key)];
+        }
+    }
+    STAT(op_stats.nodes++);
+
+    // Pending leaves are reachable only through forward links
+    if (pending_count_ > 0) {
+        while (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) {
+            x = x->forward;
+            STAT(op_stats.nodes++);
+        }
+    }
+    return x;
+}
+
+// Each run of sorted keys that falls into one leaf is merged into the leaf's
+// array with a single backward pass, as long as the leaf keeps a free slot.
+// The key that no longer fits goes through the lazy insertion to split the
+// leaf, and the upper-level entries of all leaves split by the batch are
+// inserted at the end.
+template<typename Key>
+void SkipList<Key>::InsertBatch(Key* keys, size_t n) {
+    if (recorder_ != nullptr) {
+        for (size_t i = 0; i < n; i++) recorder_->OnInsert(keys[i]);
+    }
+    std::sort(keys, keys + n);
+    Key fresh[ARR_SIZE];
+
+    Node* leaf = head_[0];
+    size_t i = 0;
+    while (i < n) {
+        // Sorted keys move rightwards, so try a few forward links before descending again
+        int hop = 0;
+        while (leaf != head_[0] && leaf->forward != nullptr && compare_(leaf->forward->keys[0], keys[i]) <= 0) {
+            if (hop++ == BATCH_HOPS) break;
+            leaf = leaf->forward;
+        }
+        if (leaf == head_[0] || hop > BATCH_HOPS) {
+            leaf = FindLeaf(keys[i]);
+        }
+        if (leaf == head_[0]) { // Below the first leader, needs the generic case analysis
+            InsertImpl(keys[i++], Value(), false, true);
+            continue;
+        }
+
+        // Keys in [i, j) belong to this leaf
+        size_t j = i;
+        while (j < n && (leaf->forward == nullptr || compare_(keys[j], leaf->forward->keys[0]) < 0)) j++;
+
+        // Collect the new keys of the run while the leaf keeps a free slot
+        int room = ARR_SIZE - 1 - leaf->N_key;
+        int added = 0;
+        while (i < j && added < room) {
+            if ((added == 0 || keys[i] != fresh[added-1]) && !std::binary_search(leaf->keys, leaf->keys + leaf->N_key, keys[i])) {
+                fresh[added++] = keys[i];
+            }
+            i++;
+        }
+
+        if (added > 0) {
+            Preserve(leaf);
+            Value* values = leaf->values;
+            int a = leaf->N_key - 1;
+            int b = added - 1;
+            int w = leaf->N_key + added - 1;
+            while (b >= 0) {
+                if (a >= 0 && compare_(leaf->keys[a], fresh[b]) > 0) {
+                    if (values != nullptr) values[w] = values[a];
+                    leaf->keys[w--] = leaf->keys[a--];
+                } else {
+                    if (values != nullptr) values[w] = Value();
+                    leaf->keys[w--] = fresh[b--];
+                }
+            }
+            CountShift(); // Signal.Jin
+            leaf->N_key += added;
+            AdjustCounts(leaf, added, OneValue(Value()));
+        }
+
+        if (i < j) {
+            InsertImpl(keys[i++], Value(), false, true);
+        }
+    }
+    DrainPending(PENDING_SIZE);
+}
+
+// Sort keys in place with one chunk per thread, then merge chunk pairs in rounds
+template<typename Key>
+void ParallelSort(Key* keys, size_t n, int threads) {
+    std::vector<size_t> bound(threads + 1);
+    for (int t = 0; t <= threads; t++) {
+        bound[t] = n * t / threads;
+    }
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([=, &bound]() { std::sort(keys + bound[t], keys + bound[t+1]); });
+    }
+    for (auto& w : workers) w.join();
+
+    for (int width = 1; width < threads; width *= 2) {
+        workers.clear();
+        for (int t = 0; t + width < threads; t += 2 * width) {
+            size_t lo = bound[t], mid = bound[t + width], hi = bound[std::min(t + 2 * width, threads)];
+            workers.emplace_back([=]() { std::inplace_merge(keys + lo, keys + mid, keys + hi); });
+        }
+        for (auto& w : workers) w.join();
+    }
+}
+
+// Chain leaves holding keys[lo, hi) and their values unless values is nullptr,
+// skipping duplicates (also across lo)
+template<typename Key>
+typename SkipList<Key>::Node*
+SkipList<Key>::BuildLeaves(const Key* keys, const Value* values, size_t lo, size_t hi, Node** last, size_t* count) {
+    Node* first = nullptr;
+    Node* x = nullptr;
+    *count = 0;
+    for (size_t i = lo; i < hi; i++) {
+        if (i > 0 && keys[i] == keys[i-1]) continue;
+        if (x == nullptr || x->N_key == BULK_FILL) {
+            Node* add_node = NewNode(keys[i]);
+            if (x == nullptr) first = add_node; else x->forward = add_node;
+            x = add_node;
+            (*count)++;
+        } else {
+            x->keys[x->N_key++] = keys[i];
+        }
+        if (values != nullptr && values[i] != Value()) {
+            if (x->values == nullptr) x->values = new Value[ARR_SIZE]();
+            x->values[x->N_key - 1] = values[i];
+        }
+    }
+    *last = x;
+    return first;
+}
+
+// Chain parents over n_child nodes linked by forward, starting at first
+template<typename Key>
+typename SkipList<Key>::Node*
+SkipList<Key>::BuildLevel(Node* first, size_t n_child, int level, Node** last, size_t* count) {
+    Node* head = nullptr;
+    Node* x = nullptr;
+    Node* child = first;
+    *count = 0;
+    for (size_t i = 0; i < n_child; i++, child = child->forward) {
+        if (x == nullptr || x->N_key == BULK_FILL) {
+            Node* add_node = NewNode(child->keys[0]);
+            add_node->next[0] = child;
+            Counts(add_node)[0] = SubtreeSize(child, level - 1);
+            add_node->summaries[0] = SubtreeValues(child, level - 1);
+            if (x == nullptr) head = add_node; else x->forward = add_node;
+            x = add_node;
+            (*count)++;
+        } else {
+            x->keys[x->N_key] = child->keys[0];
+            x->counts[x->N_key] = SubtreeSize(child, level - 1);
+            x->summaries[x->N_key] = SubtreeValues(child, level - 1);
+            x->next[x->N_key++] = child;
+        }
+    }
+    *last = x;
+    return head;
+}
+
+// Each thread builds the leaves and their first index level for one key range,
+// with ranges aligned to BULK_FILL * BULK_FILL keys so only range boundaries
+// may leave underfull nodes. The ranges are stitched through forward links and
+// the remaining levels are built on top until the top level is a single node
+// that still has a room, as the top level is entered through its first node only.
+// A non-empty list falls back to InsertBatch.
+template<typename Key>
+void SkipList<Key>::ParallelBulkLoad(Key* keys, size_t n, int threads) {
+    const size_t span = (size_t)BULK_FILL * BULK_FILL;
+    threads = std::max(1, std::min<int>(threads, (n + span - 1) / span));
+
+    if (!std::is_sorted(keys, keys + n)) {
+        ParallelSort(keys, n, threads);
+    }
+    if (head_[0]->forward != nullptr) {
+        InsertBatch(keys, n);
+        return;
+    }
+    if (recorder_ != nullptr) {
+        for (size_t i = 0; i < n; i++) recorder_->OnInsert(keys[i]);
+    }
+    BuildFrom(keys, nullptr, n, threads);
+}
+
+template<typename Key>
+void SkipList<Key>::BuildFrom(const Key* keys, const Value* values, size_t n, int threads) {
+    const size_t span = (size_t)BULK_FILL * BULK_FILL;
+    threads = std::max(1, std::min<int>(threads, (n + span - 1) / span));
+    if (n == 0) return;
+
+    struct Range {
+        Node* first[2];
+        Node* last[2];
+        size_t count[2];
+    };
+    std::vector<Range> range(threads);
+    const size_t chunk = ((n / threads + span - 1) / span) * span;
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([=, &range]() {
+            size_t lo = std::min(n, chunk * t), hi = std::min(n, chunk * (t + 1));
+            Range& r = range[t];
+            r.first[0] = BuildLeaves(keys, values, lo, hi, &r.last[0], &r.count[0]);
+            r.first[1] = BuildLevel(r.first[0], r.count[0], 1, &r.last[1], &r.count[1]);
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    // Stitch the ranges level by level
+    Node* first[2] = {nullptr, nullptr};
+    size_t count[2] = {0, 0};
+    for (int l = 0; l < 2; l++) {
+        Node* x = nullptr;
+        for (int t = 0; t < threads; t++) {
+            if (range[t].count[l] == 0) continue;
+            if (x == nullptr) first[l] = range[t].first[l]; else x->forward = range[t].first[l];
+            x = range[t].last[l];
+            count[l] += range[t].count[l];
+        }
+    }
+
+    head_[0]->forward = first[0];
+    int level = 0;
+    Node* top = first[0];
+    size_t n_top = count[0];
+    if (n_top > 1 || top->N_key == ARR_SIZE) {
+        head_[1]->forward = first[1];
+        level = 1;
+        top = first[1];
+        n_top = count[1];
+    }
+    while (n_top > 1 || top->N_key == ARR_SIZE) {
+        Node* last;
+        size_t n_child = n_top;
+        top = BuildLevel(top, n_child, level + 1, &last, &n_top);
+        head_[++level]->forward = top;
+    }
+    max_height_ = level + 1;
+    SyncTail();
+    for (Node* x = first[0]; values != nullptr && x != nullptr; x = x->forward) { // Counted here, as the workers race
+        if (x->values != nullptr) value_nodes_++;
+    }
+}
+
+// Merge the child at parent->next[idx+1] into its left sibling parent->next[idx],
+// drop its entry from the parent and free it
+template<typename Key>
+void SkipList<Key>::MergeInto(Node* parent, int idx, int level) {
+    Node* left = parent->next[idx];
+    Node* right = parent->next[idx+1];
+    Preserve(left);
+    Preserve(parent);
+
+    std::memcpy(&left->keys[left->N_key], right->keys, right->N_key * sizeof(Key));
+    if (level == 0) {
+        CopyValues(left, left->N_key, right, 0, right->N_key);
+    } else {
+        std::memcpy(&left->next[left->N_key], right->next, right->N_key * sizeof(right->next[0]));
+        std::memcpy(&Counts(left)[left->N_key], Counts(right), right->N_key * sizeof(uint32_t));
+        std::memcpy(&left->summaries[left->N_key], right->summaries, right->N_key * sizeof(ValueSummary));
+    }
+    left->N_key += right->N_key;
+    left->forward = right->forward;
+    if (tail_[level] == right) tail_[level] = left;
+
+    Memmove(&parent->keys[idx+1], &parent->keys[idx+2], (parent->N_key - (idx+2)) * sizeof(Key));
+    Memmove(&parent->next[idx+1], &parent->next[idx+2], (parent->N_key - (idx+2)) * sizeof(parent->next[0]));
+    uint32_t* counts = Counts(parent);
+    ValueSummary* summaries = parent->summaries;
+    counts[idx] += counts[idx+1];
+    Fold(summaries[idx], summaries[idx+1]);
+    Memmove(&counts[idx+1], &counts[idx+2], (parent->N_key - (idx+2)) * sizeof(uint32_t));
+    Memmove(&summaries[idx+1], &summaries[idx+2], (parent->N_key - (idx+2)) * sizeof(ValueSummary));
+    CountShift(); // Signal.Jin
+    parent->N_key--;
+    parent->keys[parent->N_key] = 0;
+    parent->next[parent->N_key] = nullptr;
+    counts[parent->N_key] = 0;
+    summaries[parent->N_key] = ValueSummary();
+
+    Retire(right);
+}
+
+// Move the first n entries of the child at parent->next[idx+1] to the end of
+// its left sibling, and move its parent entry to its new leader
+template<typename Key>
+void SkipList<Key>::ShiftInto(Node* parent, int idx, int level, int n) {
+    Node* left = parent->next[idx];
+    Node* right = parent->next[idx+1];
+    Preserve(left);
+    Preserve(right);
+    Preserve(parent);
+
+    int rest = right->N_key - n;
+    std::memcpy(&left->keys[left->N_key], right->keys, n * sizeof(Key));
+    Memmove(right->keys, &right->keys[n], rest * sizeof(Key));
+    std::fill(right->keys + rest, right->keys + right->N_key, 0);
+    if (level == 0) {
+        CopyValues(left, left->N_key, right, 0, n);
+        CopyValues(right, 0, right, n, rest);
+    } else {
+        std::memcpy(&left->next[left->N_key], right->next, n * sizeof(right->next[0]));
+        std::memcpy(&Counts(left)[left->N_key], Counts(right), n * sizeof(uint32_t));
+        std::memcpy(&left->summaries[left->N_key], right->summaries, n * sizeof(ValueSummary));
+        Memmove(right->next, &right->next[n], rest * sizeof(right->next[0]));
+        Memmove(right->counts, &right->counts[n], rest * sizeof(uint32_t));
+        Memmove(right->summaries, &right->summaries[n], rest * sizeof(ValueSummary));
+        std::fill(right->next + rest, right->next + right->N_key, nullptr);
+        std::fill(right->counts + rest, right->counts + right->N_key, 0);
+        std::fill(right->summaries + rest, right->summaries + right->N_key, ValueSummary());
+    }
+    CountShift(); // Signal.Jin
+    left->N_key += n;
+    right->N_key = rest;
+
+    parent->keys[idx+1] = right->keys[0];
+    for (int i = idx; i <= idx + 1; i++) {
+        Counts(parent)[i] = SubtreeSize(parent->next[i], level);
+        parent->summaries[i] = SubtreeValues(parent->next[i], level);
+    }
+}
+
+// Nodes freed among the children of parent by the pass of Compact, which
+// merges a child into its left sibling when both fit in COMPACT_FILL entries,
+// and with shift otherwise tops the left sibling up to COMPACT_FILL from it
+template<typename Key>
+int SkipList<Key>::PackFrees(Node* parent, bool shift) const {
+    int freed = 0;
+    int fill = parent->next[0]->N_key; // Of the left sibling as the pass reaches each child
+    for (int i = 1; i < parent->N_key; i++) {
+        int n_key = parent->next[i]->N_key;
+        if (parent->next[i-1]->forward == parent->next[i] && fill + n_key <= COMPACT_FILL) {
+            fill += n_key;
+            freed++;
+        } else if (shift && parent->next[i-1]->forward == parent->next[i] && fill < COMPACT_FILL) {
+            fill = n_key - (COMPACT_FILL - fill);
+        } else {
+            fill = n_key;
+        }
+    }
+    return freed;
+}
+
+// Walks the parents of one level at a time, merging siblings that share a
+// parent, so no leader key above the parent changes. Siblings that are each
+// too full to merge with the next, as the leaves of random inserts mostly are,
+// are packed up to COMPACT_FILL from left to right when that frees more nodes
+// than merging alone. Parents on the top level are never merged, as lookups
+// enter the top level through its first node only.
+template<typename Key>
+int SkipList<Key>::Compact(int budget) {
+    DrainPending(PENDING_SIZE);
+    int freed = 0;
 
-    inline int GetMaxHeight() const {
-        return max_height_;
-    }
+    while (budget-- > 0) {
+        if (compact_level_ + 1 >= GetMaxHeight()) { // Finished a pass
+            compact_level_ = 0;
+            compact_cursor_ = nullptr;
+            break;
+        }
+        Node* parent = (compact_cursor_ == nullptr) ? head_[compact_level_ + 1]->forward : compact_cursor_;
+        if (parent == nullptr) {
+            compact_level_++;
+            compact_cursor_ = nullptr;
+            continue;
+        }
 
-    inline int randomLevel() {
-        int level = 0;
-        while (std::rand() % 4 == 0 && level < MAXHEIGHT) { level++; }
-        if (level+1 > max_height_) { max_height_ = level+1; }
-        return level;
+        bool pack = PackFrees(parent, true) > PackFrees(parent, false);
+        int i = 0;
+        while (i < parent->N_key - 1) {
+            Node* left = parent->next[i];
+            Node* right = parent->next[i+1];
+            if (left->forward == right && left->N_key + right->N_key <= COMPACT_FILL) {
+                MergeInto(parent, i, compact_level_);
+                freed++;
+            } else {
+                if (pack && left->forward == right && left->N_key < COMPACT_FILL) {
+                    ShiftInto(parent, i, compact_level_, COMPACT_FILL - left->N_key);
+                }
+                i++;
+            }
+        }
+
+        compact_cursor_ = parent->forward;
+        if (compact_cursor_ == nullptr) compact_level_++;
     }
+    return freed;
+}
 
-    Node* NewNode(const Key& key); // Make a new node with key
+template<typename Key>
+size_t SkipList<Key>::SubtreeSize(Node* x, int level) const {
+    if (level == 0) return x->N_key;
+    size_t n = 0;
+    for (int i = 0; x->counts != nullptr && i < x->N_key; i++) {
+        n += x->counts[i];
+    }
+    return n;
+}
 
-    // Intra-node search with linear search and SIMD
-    int findMaxLessOrEqualLinear(Key arr[], Key target, int size) const;
-    int findMaxLessOrEqualLinearSIMD(Key arr[], Key target, int size) const;
+template<typename Key>
+typename SkipList<Key>::ValueSummary
+SkipList<Key>::SubtreeValues(Node* x, int level) const {
+    ValueSummary summary = NoValues();
+    if (level == 0 && x->values == nullptr) return (x->N_key > 0) ? OneValue(Value()) : summary;
+    for (int i = 0; i < x->N_key; i++) {
+        if (level == 0) Fold(summary, OneValue((x->values != nullptr) ? x->values[i] : Value()));
+        else if (x->summaries != nullptr) Fold(summary, x->summaries[i]);
+    }
+    return summary;
+}
 
-    // Intra-node search with branchless binary search
-    // findMaxLessOrEqual == findMaxLessOrEqualBinary
-    int findMaxLessOrEqual(Key arr[], Key target) const; 
-    int findMaxLessOrEqualBinary(Key arr[], Key target) const; 
-};
+template<typename Key>
+void SkipList<Key>::Recount(Node* x, int level) {
+    uint32_t* counts = Counts(x);
+    for (int i = 0; i < x->N_key; i++) {
+        counts[i] = SubtreeSize(x->next[i], level - 1);
+        x->summaries[i] = SubtreeValues(x->next[i], level - 1);
+    }
+    std::fill(counts + x->N_key, counts + ARR_SIZE, 0);
+    std::fill(x->summaries + x->N_key, x->summaries + ARR_SIZE, ValueSummary());
+}
 
+template<typename Key>
+int SkipList<Key>::MarkSpine(Node* prev_[], const int slot_[], SpineMark mark[]) {
+    int levels = std::min(kMaxHeight_, GetMaxHeight() + 1); // An insert raises the height by one at most
+    for (int i = 0; i < levels; i++) {
+        Node* first = (prev_[i] == head_[i]) ? head_[i]->forward : prev_[i];
+        mark[i].node = prev_[i];
+        mark[i].to = (first == nullptr) ? nullptr : first->forward;
+        mark[i].nodes = (first == nullptr) ? 0 : 1;
+        mark[i].n_key = (first == nullptr) ? 0 : first->N_key;
+        mark[i].next_n_key = 0;
+        mark[i].slot = (slot_ == nullptr || prev_[i] == head_[i]) ? -1 : slot_[i];
+    }
+    return levels;
+}
 
+// Inserts only add nodes right after the spine node of a level (or in front of
+// the first node when the spine is at the head), so the nodes between it and
+// its old forward are all that changed. A level that kept a single spine node
+// with the same N_key only needs the entry above it adjusted, while the spine
+// nodes of a level whose children were split or indexed are recounted fully.
+// An exact delta comes from the single key inserted, so its value is folded in.
 template<typename Key>
-struct SkipList<Key>::Node {
-    Key keys[ARR_SIZE]; // keys[0] = leader key of current node
-    Node* forward;
-    Node* next[ARR_SIZE];
-    int N_key;
+void SkipList<Key>::RecountSpine(const SpineMark mark[], int levels, const Value& value) {
+    Node* child = nullptr; // Single spine node of the level below, nullptr if several
+    int delta = 0;         // Key count change under child, valid while exact
+    bool exact = true;
 
-    Node(Key key) : N_key(1) {
-        this->forward = nullptr;
-        for(int i = 0; i < ARR_SIZE; i++) {
-            keys[i] = 0;
-            next[i] = nullptr;
+    levels = std::min(levels, GetMaxHeight());
+    for (int l = 0; l < levels; l++) {
+        Node* first = (mark[l].node == head_[l]) ? head_[l]->forward : mark[l].node;
+        int nodes = 0;
+        for (Node* x = first; x != nullptr && x != mark[l].to; x = x->forward) nodes++;
+        if (nodes == 0) return;
+        bool reshaped = (nodes != mark[l].nodes) || (l > 0 && first->N_key != mark[l].n_key);
+
+        if (l == 0) {
+            delta = first->N_key - mark[0].n_key;
+        } else if (child == nullptr || reshaped) {
+            for (Node* x = first; x != nullptr && x != mark[l].to; x = x->forward) {
+                Recount(x, l);
+            }
+            exact = false;
+        } else {
+            if (exact && delta == 0) return; // Nothing below changed, e.g. a duplicate key
+            int idx = mark[l].slot;
+            if (idx < 0 || idx >= first->N_key || first->next[idx] != child) {
+                idx = findMaxLessOrEqual(first->keys, child->keys[0]);
+                if (first->next[idx] != child) return; // Child is a pending leaf, no entry covers it yet
+            }
+            if (exact) {
+                Counts(first)[idx] += delta;
+                Fold(first->summaries[idx], OneValue(value));
+            } else {
+                Counts(first)[idx] = SubtreeSize(child, l - 1);
+                first->summaries[idx] = SubtreeValues(child, l - 1);
+            }
         }
-        this->keys[0] = key;
+        child = (nodes == 1) ? first : nullptr;
     }
-};
+}
 
+// The breakdown variants do not split a full node but spill its last key or
+// entry into the node after it, so that node is marked on every level as well
 template<typename Key>
-typename SkipList<Key>::Node*
-SkipList<Key>::NewNode(const Key& key) {
-    return new Node(key);
+int SkipList<Key>::MarkSpill(Node* prev_[], SpineMark mark[]) {
+    int levels = MarkSpine(prev_, nullptr, mark);
+    for (int i = 0; i < levels; i++) {
+        if (mark[i].to == nullptr) continue;
+        mark[i].next_n_key = mark[i].to->N_key;
+        mark[i].to = mark[i].to->forward;
+        mark[i].nodes++;
+    }
+    return levels;
 }
 
+// An entry spilled between the marked nodes of a level leaves its count behind,
+// so a level whose marked nodes changed in number or N_key is recounted fully.
+// Otherwise only the entries over the marked nodes of the level below are
+// updated: by the key count change of each, as long as no level below was
+// recounted, and their summaries only if the list carries values at all.
 template<typename Key>
-SkipList<Key>::SkipList() {
-    kMaxHeight_ = MAXHEIGHT;
-    max_height_ = 1;
-    shift_count = 0;
-    split_count = 0;
+void SkipList<Key>::RecountSpill(const SpineMark mark[], int levels) {
+    int delta[2] = {0, 0}; // Key count change of the marked nodes of the level below, valid while exact
+    bool exact = true;
 
-    for(int i = 0; i < kMaxHeight_; i++) {
-        head_[i] = NewNode(Key());  
+    levels = std::min(levels, GetMaxHeight());
+    for (int l = 0; l < levels; l++) {
+        Node* first = (mark[l].node == head_[l]) ? head_[l]->forward : mark[l].node;
+        if (first == nullptr) return;
+        int nodes = 0;
+        int changed[2] = {0, 0};
+        for (Node* x = first; x != nullptr && x != mark[l].to; x = x->forward) {
+            if (nodes < 2) changed[nodes] = x->N_key - ((nodes == 0) ? mark[l].n_key : mark[l].next_n_key);
+            nodes++;
+        }
+        bool reshaped = (nodes != mark[l].nodes);
+
+        if (l == 0) {
+            exact = !reshaped;
+            delta[0] = changed[0];
+            delta[1] = changed[1];
+            continue;
+        }
+        if (reshaped || changed[0] != 0 || changed[1] != 0) {
+            for (Node* x = first; x != nullptr && x != mark[l].to; x = x->forward) {
+                Recount(x, l);
+            }
+            exact = false;
+            continue;
+        }
+        if (exact && delta[0] == 0 && delta[1] == 0 && value_nodes_ == 0) return; // Nothing below changed
+
+        int next_delta[2] = {0, 0};
+        Node* below = (mark[l-1].node == head_[l-1]) ? head_[l-1]->forward : mark[l-1].node;
+        int k = 0;
+        for (Node* child = below; child != nullptr && child != mark[l-1].to; child = child->forward, k++) {
+            int j = 0;
+            for (Node* x = first; x != nullptr && x != mark[l].to; x = x->forward, j++) {
+                int idx = findMaxLessOrEqual(x->keys, child->keys[0]);
+                if (x->next[idx] != child) continue; // Not covered by x, or by any entry yet
+                if (exact) {
+                    Counts(x)[idx] += delta[k];
+                    next_delta[j] += delta[k];
+                } else {
+                    Counts(x)[idx] = SubtreeSize(child, l - 1);
+                }
+                if (value_nodes_ > 0) x->summaries[idx] = SubtreeValues(child, l - 1);
+                break;
+            }
+        }
+        delta[0] = next_delta[0];
+        delta[1] = next_delta[1];
     }
 }
 
+// Add delta keys with values summarized by added to the entries above leaf,
+// unless it is not indexed yet
 template<typename Key>
-int SkipList<Key>::findMaxLessOrEqualLinear(Key arr[], Key target, int size) const {
-    for (int i = 0; i < size; ++i) {
-        if (compare_(arr[i], target) > 0) {
-            return i - 1;
-        }
+void SkipList<Key>::AdjustCounts(Node* leaf, int delta, const ValueSummary& added) {
+    Node* path[MAXHEIGHT];
+    int idx[MAXHEIGHT];
+    int height = GetMaxHeight() - 1;
+    Node* x = head_[height]->forward;
+    if (height == 0 || x == nullptr || compare_(x->keys[0], leaf->keys[0]) > 0) return;
+
+    for (int l = height; l > 0; l--) {
+        path[l] = x;
+        idx[l] = findMaxLessOrEqual(x->keys, leaf->keys[0]);
+        x = x->next[idx[l]];
+    }
+    if (x != leaf) return;
+    for (int l = 1; l <= height; l++) {
+        Counts(path[l])[idx[l]] += delta;
+        Fold(path[l]->summaries[idx[l]], added);
     }
-    return size - 1;
 }
 
+// A value changed in place can lower a maximum or raise a minimum, so the
+// entries on the path are recomputed from their children, bottom-up
 template<typename Key>
-int SkipList<Key>::findMaxLessOrEqualLinearSIMD(Key arr[], Key target, int size) const {
-    constexpr int simdWidth = 2;
-    __m128i targetVec = _mm_set1_epi64x(static_cast<uint64_t>(target));
-    int maxIndex = -1;
-    int i = 0;
-    for (; i <= size - simdWidth; i += simdWidth) {
-        __m128i dataVec = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&arr[i]));
-        __m128i cmp_gt = _mm_cmpgt_epi64(dataVec, targetVec);
-        __m128i cmp_le = _mm_cmpeq_epi64(cmp_gt, _mm_setzero_si128());
-        int mask = _mm_movemask_pd(_mm_castsi128_pd(cmp_le));
+void SkipList<Key>::RefreshPath(Node* leaf) {
+    Node* path[MAXHEIGHT];
+    int idx[MAXHEIGHT];
+    int height = GetMaxHeight() - 1;
+    Node* x = head_[height]->forward;
+    if (height == 0 || x == nullptr || compare_(x->keys[0], leaf->keys[0]) > 0) return;
 
-        if (mask != 0) {
-            int bitPos = (mask == 1) ? 0 : 1;
-            maxIndex = i + bitPos;
-        }
+    for (int l = height; l > 0; l--) {
+        path[l] = x;
+        idx[l] = findMaxLessOrEqual(x->keys, leaf->keys[0]);
+        x = x->next[idx[l]];
     }
-    for (; i < size; ++i) {
-        if (compare_(arr[i], target) <= 0) {
-            maxIndex = i;
-        }
+    if (x != leaf) return;
+    for (int l = 1; l <= height; l++) {
+        Summaries(path[l])[idx[l]] = SubtreeValues(path[l]->next[idx[l]], l - 1);
     }
-    return maxIndex;
 }
 
 template<typename Key>
-int SkipList<Key>::findMaxLessOrEqualBinary(Key arr[], Key target) const {
-    Key* begin = arr;
-    std::size_t step = ARR_SIZE;
-    
-    for (step /= 2; step != 0; step /= 2) {
-        Key* probe = begin + step;
-        bool valid = (*probe <= target) && *probe != 0;
-        begin += step * valid;
+void SkipList<Key>::SaveValues(const SpineMark& mark, LeafValues* saved) const {
+    Node* first = (mark.node == head_[0]) ? head_[0]->forward : mark.node;
+    saved->n_key = 0;
+    bool values = false;
+    for (Node* x = first; x != nullptr && x != mark.to; x = x->forward) {
+        values = values || x->values != nullptr;
+    }
+    if (!values) return;
+    for (Node* x = first; x != nullptr && x != mark.to; x = x->forward) {
+        std::memcpy(&saved->keys[saved->n_key], x->keys, x->N_key * sizeof(Key));
+        if (x->values != nullptr) std::memcpy(&saved->values[saved->n_key], x->values, x->N_key * sizeof(Value));
+        else std::fill(&saved->values[saved->n_key], &saved->values[saved->n_key + x->N_key], Value());
+        saved->n_key += x->N_key;
     }
-    return begin - arr;
 }
 
+// The nodes the insert left between the spine node and its old forward hold
+// the saved keys plus possibly key, in order, so one merge pass gives every
+// saved key its value back and key, if new, gets value
 template<typename Key>
-int SkipList<Key>::findMaxLessOrEqual(Key arr[], Key target) const {
-    Key* begin = arr;
-    std::size_t step = ARR_SIZE;
-    
-    for (step /= 2; step != 0; step /= 2) {
-        Key* probe = begin + step;
-        bool valid = (*probe <= target) && *probe != 0;
-        begin += step * valid;
+void SkipList<Key>::RestoreValues(const SpineMark& mark, const LeafValues& saved, const Key& key, const Value& value) {
+    if (saved.n_key == 0 && value == Value()) return;
+    Node* first = (mark.node == head_[0]) ? head_[0]->forward : mark.node;
+    int j = 0;
+    for (Node* x = first; x != nullptr && x != mark.to; x = x->forward) {
+        for (int i = 0; i < x->N_key; i++) {
+            while (j < saved.n_key && compare_(saved.keys[j], x->keys[i]) < 0) j++;
+            if (j < saved.n_key && compare_(saved.keys[j], x->keys[i]) == 0) {
+                SetValue(x, i, saved.values[j]);
+            } else {
+                SetValue(x, i, (compare_(x->keys[i], key) == 0) ? value : Value());
+            }
+        }
     }
-    return begin - arr;
 }
 
 template<typename Key>
-void SkipList<Key>::Insert_usplit(const Key& key) {
+void SkipList<Key>::InsertImpl(const Key& key, const Value& value, bool adaptive, bool lazy) {
+    STAT_OP(true);
+    STAT(op_stats.inserts++);
     Node* prev_[MAXHEIGHT];
     std::copy(std::begin(head_), std::end(head_), std::begin(prev_));
-    int height = GetMaxHeight() - 1; // Using for search
-    Node* x = head_[height]; // Use when searching
-    
-    if (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) x = x->forward;
 
-    while (true) { // Find the location which will insert the key using prev_ and head_
-        prev_[height--] = x;
-        if (height >= 0) {
-            int n_key = x->N_key;
-            if (n_key <= ARR_SIZE/2) {
-                x = (x == head_[height + 1]) ? head_[height] : x->next[findMaxLessOrEqualLinearSIMD(x->keys, key, n_key)];
+    if (adaptive) { // Track the ratio of ascending inserts to the rest
+        int sample = (compare_(last_key_, key) < 0) ? SKEW_SCALE : 0;
+        skew_ += (sample - skew_) / 16;
+        last_key_ = key;
+    }
+
+    int append = AppendFastPath(key, value, prev_);
+    if (append > 0) return;
+
+    int slot_[MAXHEIGHT]; // Entry of prev_[i] taken by the descent
+    std::fill(slot_, slot_ + GetMaxHeight(), -1);
+    if (append < 0) {
+        int height = GetMaxHeight() - 1; // Using for search
+        Node* x = head_[height]; // Use when searching
+        
+        if (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) x = x->forward;
+
+        while (true) { // Find the location which will insert the key using prev_ and head_
+            prev_[height--] = x;
+            STAT(op_stats.nodes++);
+            if (height >= 0) {
+                STAT(op_stats.levels++);
+                int n_key = x->N_key;
+                if (x == head_[height + 1]) {
+                    x = head_[height];
+                } else {
+                    slot_[height + 1] = (n_key <= ARR_SIZE/2) ? findMaxLessOrEqualLinearSIMD(x->keys, key, n_key) : findMaxLessOrEqualBinary(x->keys, key);
+                    x = x->next[slot_[height + 1]];
+                }
             } else {
-                x = (x == head_[height + 1]) ? head_[height] : x->next[findMaxLessOrEqualBinary(x->keys, key)];
+                break;
             }
-        } else {
-            break;
         }
-    }
-    // Do not allow duplicated key
-    if (prev_[0] != head_[0]) {
-        for (int i = 0; i < prev_[0]->N_key; i++) {
-            if (compare_(prev_[0]->keys[i], key) == 0) {
-                return;
+        // Pending leaves are reachable only through forward links
+        if (pending_count_ > 0) {
+            while (prev_[0]->forward != nullptr && compare_(prev_[0]->forward->keys[0], key) <= 0) {
+                prev_[0] = prev_[0]->forward;
+                STAT(op_stats.nodes++);
+            }
+        }
+        // Do not allow duplicated key
+        if (prev_[0] != head_[0]) {
+            for (int i = 0; i < prev_[0]->N_key; i++) {
+                if (compare_(prev_[0]->keys[i], key) == 0) {
+                    return;
+                }
             }
         }
     }
     
     // Do insert operation
-    int level = 0;
+    InsertLevels(prev_, slot_, key, value, 0, adaptive, lazy);
+}
+
+template<typename Key>
+void SkipList<Key>::InsertLevels(Node* prev_[], const int slot_[], const Key& key, const Value& value, int level, bool adaptive, bool lazy) {
+    PreserveSpine(prev_, level);
+    SpineMark mark[MAXHEIGHT];
+    int marked = MarkSpine(prev_, slot_, mark);
+    LeafValues saved;
+    saved.n_key = 0;
+    if (level == 0) SaveValues(mark[0], &saved);
     while (true) {
         int stop_flag = 0;
         int cur_height = GetMaxHeight() - 1;
@@ -269,8 +1777,8 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = key;
                         prev_[level]->forward->N_key++;
                         if (idx == -1) {
@@ -310,9 +1818,9 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        std::memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        Memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = prev_[level-1]->forward->keys[0];
                         prev_[level]->forward->next[idx+1] = prev_[level-1]->forward;
                         prev_[level]->forward->N_key++;
@@ -347,7 +1855,7 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                         Node* add_node = NewNode(key);
                         std::memcpy(add_node->keys+1, &prev_[level]->forward->keys[idx+1], (ARR_SIZE - (idx+1)) * sizeof(Key));
                         std::memset(&prev_[level]->forward->keys[idx+1], 0, (ARR_SIZE - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        CountShift(); // Signal.Jin
                         add_node->N_key += ARR_SIZE - (idx+1);
                         add_node->forward = prev_[level]->forward->forward;
                         prev_[level]->forward->N_key -= ARR_SIZE - (idx+1);
@@ -386,8 +1894,8 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                             prev_[level]->keys[idx+1] = key;
                             prev_[level]->N_key++;    
                         } else {
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = key;
                             prev_[level]->N_key++;
                         }
@@ -409,9 +1917,9 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                             prev_[level]->next[idx+1] = prev_[level-1];
                             prev_[level]->N_key++;
                         } else {
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                             prev_[level]->next[idx+1] = prev_[level-1];
                             prev_[level]->N_key++;
@@ -428,11 +1936,12 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                 // When creating a new node, change prev to the newly created node.
                 // Uneven-split operation
                 if (level == 0) { // Case 3-2-1: Insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     int idx = findMaxLessOrEqual(prev_[level]->keys, key);
                     if (idx == 0 && prev_[level]->keys[0] > key) idx = -1;
+                    bool skewed = !adaptive || skew_ >= SKEW_THRESHOLD;
                     { 
-                        if (idx == ARR_SIZE-1) {
+                        if (idx == ARR_SIZE-1 && skewed) {
                             {
                                 Node* add_node = NewNode(key);
                                 add_node->forward = prev_[level]->forward;
@@ -443,12 +1952,29 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                                     max_height_++;
                                 }
                             }
+                        } else if (adaptive && skewed && idx >= 0) {
+                            // Split at the insert position and keep key on the left, so an
+                            // ascending run keeps appending to the left node until it is full
+                            Node* add_node = NewNode(prev_[level]->keys[idx+1]);
+                            std::memcpy(add_node->keys, &prev_[level]->keys[idx+1], (ARR_SIZE - (idx+1)) * sizeof(Key));
+                            std::memset(&prev_[level]->keys[idx+1], 0, (ARR_SIZE - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
+                            add_node->N_key = ARR_SIZE - (idx+1);
+                            add_node->forward = prev_[level]->forward;
+                            prev_[level]->keys[idx+1] = key;
+                            prev_[level]->N_key = idx + 2;
+                            prev_[level]->forward = add_node;
+                            prev_[level] = add_node;
+                            level++; // Keep tracking
+                            if (cur_height < level) {
+                                max_height_++;
+                            }
                         } else {
                             if (idx < ARR_SIZE / 2) {
                                 Node* add_node = NewNode(prev_[level]->keys[ARR_SIZE/2]);
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 add_node->N_key = ARR_SIZE/2;
                                 add_node->forward = prev_[level]->forward;
                                 prev_[level]->forward = add_node;
@@ -458,8 +1984,8 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                                 } else {
                                     Key update_key = prev_[level]->keys[0];
                                     prev_[level]->N_key = ARR_SIZE / 2;
-                                    std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                    shift_count++; // Signal.Jin
+                                    Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->keys[idx+1] = key;
                                     prev_[level]->N_key++;
                                     if (idx == -1) {
@@ -484,13 +2010,13 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                                 Node* add_node = NewNode(prev_[level]->keys[ARR_SIZE/2]);
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 add_node->N_key = ARR_SIZE/2 + 1;
                                 add_node->forward = prev_[level]->forward;
                                 prev_[level]->forward = add_node;
                                 prev_[level] = add_node;
-                                std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[idx+1] = key;
                                 level++;
                                 if (cur_height < level) {
@@ -499,8 +2025,12 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                             }
                         }
                     }
+                    if (lazy && stop_flag == 0) { // Leave the upper levels to DrainPending
+                        DeferIndex(prev_[0]);
+                        stop_flag++;
+                    }
                 } else { // Case 3-2-2: Not insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     int idx = findMaxLessOrEqual(prev_[level]->keys, prev_[level-1]->keys[0]);
                     if (idx == 0 && prev_[level]->keys[0] > prev_[level-1]->keys[0]) idx = -1;
                     {
@@ -522,7 +2052,7 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memcpy(add_node->next, &prev_[level]->next[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(prev_[level]->next[0]));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 for (int i = ARR_SIZE/2; i < ARR_SIZE; i++) {
                                     prev_[level]->next[i] = nullptr;
                                 }
@@ -536,9 +2066,9 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                                 } else {
                                     Key update_key = prev_[level]->keys[0];
                                     prev_[level]->N_key = ARR_SIZE / 2;
-                                    std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                    std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
-                                    shift_count++; // Signal.Jin
+                                    Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                    Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                                     prev_[level]->next[idx+1] = prev_[level-1];
                                     prev_[level]->N_key++;
@@ -565,7 +2095,7 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memcpy(add_node->next, &prev_[level]->next[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(prev_[level]->next[0]));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 for (int i = ARR_SIZE/2; i < ARR_SIZE; i++) {
                                     prev_[level]->next[i] = nullptr;
                                 }
@@ -573,9 +2103,9 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
                                 add_node->forward = prev_[level]->forward;
                                 prev_[level]->forward = add_node;
                                 prev_[level] = add_node;
-                                std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
-                                shift_count++; // Signal.Jin
+                                Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                                 prev_[level]->next[idx+1] = prev_[level-1];
                                 level++;
@@ -593,10 +2123,17 @@ void SkipList<Key>::Insert_usplit(const Key& key) {
             break;
         }
     }
+    STAT(op_stats.propagations += level);
+    RestoreValues(mark[0], saved, key, value);
+    RecountSpine(mark, marked, value);
 }
 
 template<typename Key>
 void SkipList<Key>::Insert_esplit(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    DrainPending(PENDING_SIZE); // Descends through the upper levels only, which pending leaves are missing from
+    STAT_OP(true);
+    STAT(op_stats.inserts++);
     Node* prev_[MAXHEIGHT];
     std::copy(std::begin(head_), std::end(head_), std::begin(prev_));
     int height = GetMaxHeight() - 1; // Using for search
@@ -606,7 +2143,9 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
 
     while (true) { // Find the location which will insert the key using prev_ and head_
         prev_[height--] = x;
+        STAT(op_stats.nodes++);
         if (height >= 0) {
+            STAT(op_stats.levels++);
             int n_key = x->N_key;
             if (n_key <= ARR_SIZE/2) {
                 x = (x == head_[height + 1]) ? head_[height] : x->next[findMaxLessOrEqualLinearSIMD(x->keys, key, n_key)];
@@ -628,6 +2167,11 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
     }
     
     // Do insert operation
+    PreserveSpine(prev_, 0);
+    SpineMark mark[MAXHEIGHT];
+    int marked = MarkSpine(prev_, nullptr, mark);
+    LeafValues saved;
+    SaveValues(mark[0], &saved);
     int level = 0;
     while (true) {
         int stop_flag = 0;
@@ -676,8 +2220,8 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = key;
                         prev_[level]->forward->N_key++;
                         if (idx == -1) {
@@ -717,9 +2261,9 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        std::memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        Memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = prev_[level-1]->forward->keys[0];
                         prev_[level]->forward->next[idx+1] = prev_[level-1]->forward;
                         prev_[level]->forward->N_key++;
@@ -746,17 +2290,17 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
             } else { // Case 2-2: Forward node has no room, so we need to make a new node
                 // even-split operation
                 if (level == 0) { // Case 2-2-1: Insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     Node * add_node = NewNode(prev_[level]->forward->keys[ARR_SIZE/2]);
                     std::memcpy(add_node->keys, &prev_[level]->forward->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                     std::memset(&prev_[level]->forward->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                    shift_count++; // Signal.Jin
+                    CountShift(); // Signal.Jin
                     add_node->N_key = ARR_SIZE/2;
                     add_node->forward = prev_[level]->forward->forward;
                     prev_[level]->forward->forward = add_node;
                     Key update_key = prev_[level]->forward->keys[0];
-                    std::memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (ARR_SIZE/2) * sizeof(Key));
-                    shift_count++;
+                    Memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (ARR_SIZE/2) * sizeof(Key));
+                    CountShift();
                     prev_[level]->forward->N_key = (ARR_SIZE / 2) + 1;
                     prev_[level]->forward->keys[0] = key;
                     for (int update = level+1; update < GetMaxHeight(); update++) {
@@ -778,18 +2322,18 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                         max_height_++;
                     }
                 } else { // Case 2-2-2: Not insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     Node * add_node = NewNode(prev_[level]->forward->keys[ARR_SIZE/2]);
                     std::memcpy(add_node->keys, &prev_[level]->forward->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                     std::memcpy(add_node->next, &prev_[level]->forward->next[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(prev_[level]->forward->next[0]));
                     std::memset(&prev_[level]->forward->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                    shift_count++; // Signal.Jin
+                    CountShift(); // Signal.Jin
                     add_node->N_key = ARR_SIZE/2;
                     add_node->forward = prev_[level]->forward->forward;
                     prev_[level]->forward->forward = add_node;
 
-                    std::memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (ARR_SIZE/2) * sizeof(Key));
-                    shift_count++;
+                    Memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (ARR_SIZE/2) * sizeof(Key));
+                    CountShift();
                     Key update_key = prev_[level]->forward->keys[0];
                     prev_[level]->forward->N_key = (ARR_SIZE / 2) + 1;
                     prev_[level]->forward->keys[0] = prev_[level-1]->forward->keys[0];
@@ -824,8 +2368,8 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             prev_[level]->keys[idx+1] = key;
                             prev_[level]->N_key++;    
                         } else {
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = key;
                             prev_[level]->N_key++;
                         }
@@ -847,9 +2391,9 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             prev_[level]->next[idx+1] = prev_[level-1];
                             prev_[level]->N_key++;
                         } else {
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                             prev_[level]->next[idx+1] = prev_[level-1];
                             prev_[level]->N_key++;
@@ -866,14 +2410,14 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                 // When creating a new node, change prev to the newly created node.
                 // even-split operation
                 if (level == 0) { // Case 3-2-1: Insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     int idx = findMaxLessOrEqual(prev_[level]->keys, key);
                     {
                         if (idx < ARR_SIZE / 2) {
                             Node* add_node = NewNode(prev_[level]->keys[ARR_SIZE/2]);
                             std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                             std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             add_node->N_key = ARR_SIZE/2;
                             add_node->forward = prev_[level]->forward;
                             prev_[level]->forward = add_node;
@@ -883,8 +2427,8 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             } else {
                                 Key update_key = prev_[level]->keys[0];
                                 prev_[level]->N_key = ARR_SIZE / 2;
-                                std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[idx+1] = key;
                                 prev_[level]->N_key++;
                                 if (idx == -1) {
@@ -910,13 +2454,13 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             Node* add_node = NewNode(prev_[level]->keys[ARR_SIZE/2]);
                             std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                             std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             add_node->N_key = ARR_SIZE/2 + 1;
                             add_node->forward = prev_[level]->forward;
                             prev_[level]->forward = add_node;
                             prev_[level] = add_node;
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = key;
                             level++;
                             if (cur_height < level) {
@@ -925,7 +2469,7 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                         }
                     }
                 } else { // Case 3-2-2: Not insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     int idx = findMaxLessOrEqual(prev_[level]->keys, prev_[level-1]->keys[0]);
                     {
                         if (idx < ARR_SIZE / 2) {
@@ -933,7 +2477,7 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                             std::memcpy(add_node->next, &prev_[level]->next[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(prev_[level]->next[0]));
                             std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             for (int i = ARR_SIZE/2; i < ARR_SIZE; i++) {
                                 prev_[level]->next[i] = nullptr;
                             }
@@ -947,9 +2491,9 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             } else {
                                 Key update_key = prev_[level]->keys[0];
                                 prev_[level]->N_key = ARR_SIZE / 2;
-                                std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
-                                shift_count++; // Signal.Jin
+                                Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                                 prev_[level]->next[idx+1] = prev_[level-1];
                                 prev_[level]->N_key++;
@@ -976,7 +2520,7 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                             std::memcpy(add_node->next, &prev_[level]->next[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(prev_[level]->next[0]));
                             std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             for (int i = ARR_SIZE/2; i < ARR_SIZE; i++) {
                                 prev_[level]->next[i] = nullptr;
                             }
@@ -984,9 +2528,9 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
                             add_node->forward = prev_[level]->forward;
                             prev_[level]->forward = add_node;
                             prev_[level] = add_node;
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                             prev_[level]->next[idx+1] = prev_[level-1];
                             level++;
@@ -1003,10 +2547,15 @@ void SkipList<Key>::Insert_esplit(const Key& key) {
             break;
         }
     }
+    STAT(op_stats.propagations += level);
+    RestoreValues(mark[0], saved, key, Value());
+    RecountSpine(mark, marked, Value());
 }
 
 template<typename Key>
 void SkipList<Key>::Insert_Search(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    DrainPending(PENDING_SIZE); // Descends through the upper levels only, which pending leaves are missing from
     Node* prev_[MAXHEIGHT];
     std::copy(std::begin(head_), std::end(head_), std::begin(prev_));
     int height = GetMaxHeight() - 1; // Using for search
@@ -1038,6 +2587,11 @@ void SkipList<Key>::Insert_Search(const Key& key) {
     }
     
     // Do insert operation
+    PreserveSpine(prev_, 0);
+    SpineMark mark[MAXHEIGHT];
+    int marked = MarkSpill(prev_, mark);
+    LeafValues saved;
+    SaveValues(mark[0], &saved);
     int level = 0;
     while (true) {
         int stop_flag = 0;
@@ -1086,8 +2640,8 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = key;
                         prev_[level]->forward->N_key++;
                         if (idx == -1) {
@@ -1127,9 +2681,9 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        std::memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        Memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = prev_[level-1]->forward->keys[0];
                         prev_[level]->forward->next[idx+1] = prev_[level-1]->forward;
                         prev_[level]->forward->N_key++;
@@ -1186,7 +2740,7 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                             for (int do_shift = prev_[level]->N_key-1; do_shift > shift; do_shift--) {
                                 prev_[level]->keys[do_shift+1] = prev_[level]->keys[do_shift];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[shift+1] = key;
                             prev_[level]->N_key++;
                             if (prev_[level]->N_key == ARR_SIZE && prev_[level+1] == head_[level+1]) {
@@ -1218,7 +2772,7 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                                 prev_[level]->keys[do_shift+1] = prev_[level]->keys[do_shift];
                                 prev_[level]->next[do_shift+1] = prev_[level]->next[do_shift];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[shift+1] = prev_[level-1]->keys[0];
                             prev_[level]->next[shift+1] = prev_[level-1];
                             prev_[level]->N_key++;
@@ -1256,14 +2810,14 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                                 for (int do_shift = prev_[level]->N_key-2; do_shift > shift; do_shift--) {
                                     prev_[level]->keys[do_shift+1] = prev_[level]->keys[do_shift];
                                 }
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[shift+1] = key;
                                 if (prev_[level]->forward != nullptr && prev_[level]->forward->N_key < ARR_SIZE) {
                                     Key update_key = prev_[level]->forward->keys[0];
                                     for (int d_shift = prev_[level]->forward->N_key; d_shift > 0; d_shift--) {
                                         prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                                     }
-                                    shift_count++; // Signal.Jin
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->forward->keys[0] = temp_key;
                                     prev_[level]->forward->N_key++;
                                     if (false) {
@@ -1313,7 +2867,7 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                             for (int d_shift = prev_[level]->forward->N_key; d_shift > 0; d_shift--) {
                                 prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->forward->keys[0] = key;
                             prev_[level]->forward->N_key++;
                             if (false) {
@@ -1375,7 +2929,7 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                                         prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                                         prev_[level]->forward->next[d_shift] = prev_[level]->forward->next[d_shift-1];
                                     }
-                                    shift_count++; // Signal.Jin
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->forward->keys[0] = temp_key;
                                     prev_[level]->forward->next[0] = temp_next;
                                     prev_[level]->forward->N_key++;
@@ -1428,7 +2982,7 @@ void SkipList<Key>::Insert_Search(const Key& key) {
                                 prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                                 prev_[level]->forward->next[d_shift] = prev_[level]->forward->next[d_shift-1];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->forward->keys[0] = prev_[level-1]->keys[0];
                             prev_[level]->forward->next[0] = prev_[level-1];
                             prev_[level]->forward->N_key++;
@@ -1479,10 +3033,14 @@ void SkipList<Key>::Insert_Search(const Key& key) {
             break;
         }
     }
+    RestoreValues(mark[0], saved, key, Value());
+    RecountSpill(mark, marked);
 }
 
 template<typename Key>
 void SkipList<Key>::Insert_Raise(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    DrainPending(PENDING_SIZE); // Descends through the upper levels only, which pending leaves are missing from
     Node* prev_[MAXHEIGHT];
     std::copy(std::begin(head_), std::end(head_), std::begin(prev_));
     int height = GetMaxHeight() - 1; // Using for search
@@ -1510,6 +3068,11 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
     }
     
     // Do insert operation
+    PreserveSpine(prev_, 0);
+    SpineMark mark[MAXHEIGHT];
+    int marked = MarkSpill(prev_, mark);
+    LeafValues saved;
+    SaveValues(mark[0], &saved);
     int level = 0;
     while (true) {
         int stop_flag = 0;
@@ -1558,8 +3121,8 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = key;
                         prev_[level]->forward->N_key++;
                         if (idx == -1) {
@@ -1599,9 +3162,9 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        std::memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        Memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = prev_[level-1]->forward->keys[0];
                         prev_[level]->forward->next[idx+1] = prev_[level-1]->forward;
                         prev_[level]->forward->N_key++;
@@ -1658,7 +3221,7 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                             for (int do_shift = prev_[level]->N_key-1; do_shift > shift; do_shift--) {
                                 prev_[level]->keys[do_shift+1] = prev_[level]->keys[do_shift];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[shift+1] = key;
                             prev_[level]->N_key++;
                             if (prev_[level]->N_key == ARR_SIZE && prev_[level+1] == head_[level+1]) {
@@ -1690,7 +3253,7 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                                 prev_[level]->keys[do_shift+1] = prev_[level]->keys[do_shift];
                                 prev_[level]->next[do_shift+1] = prev_[level]->next[do_shift];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[shift+1] = prev_[level-1]->keys[0];
                             prev_[level]->next[shift+1] = prev_[level-1];
                             prev_[level]->N_key++;
@@ -1728,14 +3291,14 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                                 for (int do_shift = prev_[level]->N_key-2; do_shift > shift; do_shift--) {
                                     prev_[level]->keys[do_shift+1] = prev_[level]->keys[do_shift];
                                 }
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[shift+1] = key;
                                 if (prev_[level]->forward != nullptr && prev_[level]->forward->N_key < ARR_SIZE) {
                                     Key update_key = prev_[level]->forward->keys[0];
                                     for (int d_shift = prev_[level]->forward->N_key; d_shift > 0; d_shift--) {
                                         prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                                     }
-                                    shift_count++; // Signal.Jin
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->forward->keys[0] = temp_key;
                                     prev_[level]->forward->N_key++;
                                     if (false) {
@@ -1785,7 +3348,7 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                             for (int d_shift = prev_[level]->forward->N_key; d_shift > 0; d_shift--) {
                                 prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->forward->keys[0] = key;
                             prev_[level]->forward->N_key++;
                             if (false) {
@@ -1847,7 +3410,7 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                                         prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                                         prev_[level]->forward->next[d_shift] = prev_[level]->forward->next[d_shift-1];
                                     }
-                                    shift_count++; // Signal.Jin
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->forward->keys[0] = temp_key;
                                     prev_[level]->forward->next[0] = temp_next;
                                     prev_[level]->forward->N_key++;
@@ -1900,7 +3463,7 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
                                 prev_[level]->forward->keys[d_shift] = prev_[level]->forward->keys[d_shift-1];
                                 prev_[level]->forward->next[d_shift] = prev_[level]->forward->next[d_shift-1];
                             }
-                            shift_count++; // Signal.Jin
+                            CountShift(); // Signal.Jin
                             prev_[level]->forward->keys[0] = prev_[level-1]->keys[0];
                             prev_[level]->forward->next[0] = prev_[level-1];
                             prev_[level]->forward->N_key++;
@@ -1951,10 +3514,14 @@ void SkipList<Key>::Insert_Raise(const Key& key) {
             break;
         }
     }
+    RestoreValues(mark[0], saved, key, Value());
+    RecountSpill(mark, marked);
 }
 
 template<typename Key>
 void SkipList<Key>::Insert_Array(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    DrainPending(PENDING_SIZE); // Descends through the upper levels only, which pending leaves are missing from
     Node* prev_[MAXHEIGHT];
     std::copy(std::begin(head_), std::end(head_), std::begin(prev_));
     int height = GetMaxHeight() - 1;
@@ -1986,7 +3553,10 @@ void SkipList<Key>::Insert_Array(const Key& key) {
         }
     }
 
+    assert(value_nodes_ == 0); // Keys move between leaves here without their values
+    stale_counts_ = true;
     int node_height = randomLevel();
+    PreserveSpine(prev_, 0);
     int level = 0;
 
     while (level <= node_height) {
@@ -2161,6 +3731,9 @@ void SkipList<Key>::Insert_Array(const Key& key) {
 
 template<typename Key>
 bool SkipList<Key>::Contains(const Key& key) const {
+    if (recorder_ != nullptr) recorder_->OnLookup(key);
+    STAT_OP(false);
+    STAT(op_stats.lookups++);
     int height = GetMaxHeight() - 1;
     Key result_key = -1;
     Node* x = head_[height]; // Use when searching
@@ -2169,7 +3742,9 @@ bool SkipList<Key>::Contains(const Key& key) const {
 
     while (true) { // Find the location which will insert the key using prev_ and head_
         height--;
+        STAT(op_stats.nodes++);
         if (height >= 0) {
+            STAT(op_stats.levels++);
             int n_key = x->N_key;
             if (n_key <= ARR_SIZE/2) {
                 x = (x == head_[height + 1]) ? head_[height] : x->next[findMaxLessOrEqualLinearSIMD(x->keys, key, n_key)];
@@ -2179,6 +3754,14 @@ bool SkipList<Key>::Contains(const Key& key) const {
         } else break;
     }
 
+    // Pending leaves are reachable only through forward links
+    if (pending_count_ > 0) {
+        while (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) {
+            x = x->forward;
+            STAT(op_stats.nodes++);
+        }
+    }
+
     int idx2 = findMaxLessOrEqualBinary(x->keys, key);
     result_key = x->keys[idx2];
 
@@ -2189,8 +3772,20 @@ bool SkipList<Key>::Contains(const Key& key) const {
     }
 }
 
+template<typename Key>
+bool SkipList<Key>::Get(const Key& key, Value* value) const {
+    if (recorder_ != nullptr) recorder_->OnLookup(key);
+    Node* leaf = FindLeaf(key);
+    if (leaf == head_[0]) return false;
+    int i = std::lower_bound(leaf->keys, leaf->keys + leaf->N_key, key) - leaf->keys;
+    if (i == leaf->N_key || compare_(leaf->keys[i], key) != 0) return false;
+    *value = (leaf->values != nullptr) ? leaf->values[i] : Value();
+    return true;
+}
+
 template<typename Key>
 bool SkipList<Key>::Contains_Raise(const Key& key) const {
+    if (recorder_ != nullptr) recorder_->OnLookup(key);
     int height = GetMaxHeight() - 1;
     Key result_key = -1;
     Node* x = head_[height]; // Use when searching
@@ -2205,6 +3800,11 @@ bool SkipList<Key>::Contains_Raise(const Key& key) const {
         } else break;
     }
 
+    // Pending leaves are reachable only through forward links
+    if (pending_count_ > 0) {
+        while (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) x = x->forward;
+    }
+
     int n_key = x->N_key;
     int idx2 = findMaxLessOrEqualLinear(x->keys, key, n_key);
     result_key = x->keys[idx2];
@@ -2219,6 +3819,7 @@ bool SkipList<Key>::Contains_Raise(const Key& key) const {
 
 template<typename Key>
 Key SkipList<Key>::Scan(const Key& key, const int scan_num) {
+    if (recorder_ != nullptr) recorder_->OnScan(key, scan_num);
     int height = GetMaxHeight() - 1;
     int result_key;
     Key temp_key;
@@ -2241,6 +3842,11 @@ Key SkipList<Key>::Scan(const Key& key, const int scan_num) {
         } else break;
     }
 
+    // Pending leaves are reachable only through forward links
+    if (pending_count_ > 0) {
+        while (x->forward != nullptr && compare_(x->forward->keys[0], key) <= 0) x = x->forward;
+    }
+
     // Find key from entry(Array)
     if (compare_(x->keys[0], key) == 0) {
         result_key = 0;
@@ -2274,6 +3880,173 @@ Key SkipList<Key>::Scan(const Key& key, const int scan_num) {
     return temp_key;
 }
 
+template<typename Key>
+size_t SkipList<Key>::Scan(const Key& key, size_t scan_num, Key* out) const {
+    if (recorder_ != nullptr) recorder_->OnScan(key, scan_num);
+    STAT_OP(false);
+    STAT(op_stats.scans++);
+    Node* x = FindLeaf(key);
+    if (x == head_[0]) x = x->forward;
+
+    size_t n = 0;
+    int i = (x == nullptr) ? 0 : std::lower_bound(x->keys, x->keys + x->N_key, key) - x->keys;
+    while (x != nullptr && n < scan_num) {
+        for (; i < x->N_key && n < scan_num; i++) {
+            out[n++] = x->keys[i];
+        }
+        x = x->forward;
+        i = 0;
+    }
+    return n;
+}
+
+// Nodes that no upper-level entry covers, i.e. the whole top level and the
+// nodes Case 2-2-1/2-2-2 leave in front of the first covered one, are walked in
+// key order. Only the subtree holding the target is searched through the counts.
+// Lists Insert_Array touched have no counts, and are walked leaf by leaf.
+template<typename Key>
+size_t SkipList<Key>::Rank(const Key& key) {
+    DrainPending(PENDING_SIZE);
+    size_t rank = 0;
+    if (stale_counts_) {
+        for (Node* x = head_[0]->forward; x != nullptr && compare_(x->keys[0], key) < 0; x = x->forward) {
+            for (int i = 0; i < x->N_key && compare_(x->keys[i], key) < 0; i++) rank++;
+        }
+        return rank;
+    }
+    for (int l = 0; l < GetMaxHeight(); l++) {
+        Node* covered = FirstCovered(l);
+        for (Node* x = head_[l]->forward; x != nullptr && x != covered; x = x->forward) {
+            if (x->forward != nullptr && compare_(x->forward->keys[0], key) < 0) {
+                rank += SubtreeSize(x, l);
+                continue;
+            }
+            for (int h = l; h > 0; h--) {
+                int idx = findMaxLessOrEqual(x->keys, key);
+                uint32_t* counts = Counts(x);
+                for (int i = 0; i < idx; i++) {
+                    rank += counts[i];
+                }
+                x = x->next[idx];
+            }
+            for (int i = 0; i < x->N_key && compare_(x->keys[i], key) < 0; i++) {
+                rank++;
+            }
+            return rank;
+        }
+    }
+    return rank;
+}
+
+template<typename Key>
+Key SkipList<Key>::Select(size_t i) {
+    DrainPending(PENDING_SIZE);
+    if (stale_counts_) {
+        for (Node* x = head_[0]->forward; x != nullptr; x = x->forward) {
+            if (i < (size_t)x->N_key) return x->keys[i];
+            i -= x->N_key;
+        }
+        return Key();
+    }
+    for (int l = 0; l < GetMaxHeight(); l++) {
+        Node* covered = FirstCovered(l);
+        for (Node* x = head_[l]->forward; x != nullptr && x != covered; x = x->forward) {
+            size_t size = SubtreeSize(x, l);
+            if (i >= size) {
+                i -= size;
+                continue;
+            }
+            for (int h = l; h > 0; h--) {
+                uint32_t* counts = Counts(x);
+                int j = 0;
+                while (j < x->N_key - 1 && i >= counts[j]) {
+                    i -= counts[j++];
+                }
+                x = x->next[j];
+            }
+            return x->keys[i];
+        }
+    }
+    return Key();
+}
+
+template<typename Key>
+size_t SkipList<Key>::Size() {
+    DrainPending(PENDING_SIZE);
+    size_t n = 0;
+    if (stale_counts_) {
+        for (Node* x = head_[0]->forward; x != nullptr; x = x->forward) n += x->N_key;
+        return n;
+    }
+    for (int l = 0; l < GetMaxHeight(); l++) {
+        Node* covered = FirstCovered(l);
+        for (Node* x = head_[l]->forward; x != nullptr && x != covered; x = x->forward) {
+            n += SubtreeSize(x, l);
+        }
+    }
+    return n;
+}
+
+template<typename Key>
+size_t SkipList<Key>::CountRange(const Key& lo, const Key& hi) {
+    if (compare_(lo, hi) >= 0) return 0;
+    return Rank(hi) - Rank(lo);
+}
+
+// Fold the keys of x in [lo, hi) into summary and their values into values.
+// The keys under x are below *end, or unbounded if end is nullptr, so an entry
+// whose whole key range lies in [lo, hi) is taken from its count and summary,
+// and only the entries straddling lo or hi are descended into.
+template<typename Key>
+void SkipList<Key>::FoldRange(Node* x, int level, const Key& lo, const Key& hi, const Key* end, Summary* summary, ValueSummary* values) {
+    for (int i = 0; i < x->N_key && compare_(x->keys[i], hi) < 0; i++) {
+        if (level == 0) {
+            if (compare_(x->keys[i], lo) < 0) continue;
+            summary->count++;
+            Fold(*values, OneValue((x->values != nullptr) ? x->values[i] : Value()));
+            continue;
+        }
+        const Key* upper = (i + 1 < x->N_key) ? &x->keys[i+1] : end;
+        if (upper != nullptr && compare_(*upper, lo) <= 0) continue;
+        if (compare_(x->keys[i], lo) >= 0 && upper != nullptr && compare_(*upper, hi) <= 0) {
+            summary->count += Counts(x)[i];
+            Fold(*values, x->summaries[i]);
+        } else {
+            FoldRange(x->next[i], level - 1, lo, hi, upper, summary, values);
+        }
+    }
+}
+
+// Walks the nodes no upper-level entry covers like Rank, so only the O(log n)
+// nodes on the paths to lo and hi are read below them
+template<typename Key>
+typename SkipList<Key>::Summary
+SkipList<Key>::Aggregate(const Key& lo, const Key& hi) {
+    Summary summary = {0, Value(), Value(), Value()};
+    if (compare_(lo, hi) >= 0) return summary;
+    DrainPending(PENDING_SIZE);
+
+    ValueSummary values = NoValues();
+    if (stale_counts_) {
+        for (Node* x = head_[0]->forward; x != nullptr && compare_(x->keys[0], hi) < 0; x = x->forward) {
+            FoldRange(x, 0, lo, hi, nullptr, &summary, &values);
+        }
+    }
+    for (int l = 0; !stale_counts_ && l < GetMaxHeight(); l++) {
+        Node* covered = FirstCovered(l);
+        for (Node* x = head_[l]->forward; x != nullptr && x != covered; x = x->forward) {
+            const Key* end = (x->forward != nullptr) ? &x->forward->keys[0] : nullptr;
+            FoldRange(x, l, lo, hi, end, &summary, &values);
+        }
+    }
+    if (summary.count > 0) {
+        summary.sum = values.sum;
+        summary.min = values.min;
+        summary.max = values.max;
+    }
+    return summary;
+}
+
 template<typename Key>
 void SkipList<Key>::Print() const {
     printf("Print height - %d\n", GetMaxHeight());
@@ -2292,6 +4065,61 @@ void SkipList<Key>::Print() const {
     }
 }
 
+// Every leaf covered by a level-1 entry has its N_key in that entry's subtree
+// count, so the leaves are accounted without being touched and the walk costs
+// about one node per ARR_SIZE/2 leaves. Leaves no entry covers yet (pending or
+// in front of the first covered one) are read directly, and so are all leaves
+// once Insert_Array left the counts stale.
+template<typename Key>
+typename SkipList<Key>::MemoryUsage
+SkipList<Key>::MemoryStats() const {
+    MemoryUsage usage;
+    std::memset(&usage, 0, sizeof(usage));
+    usage.height = GetMaxHeight();
+    const size_t augment_bytes = ARR_SIZE * (sizeof(uint32_t) + sizeof(ValueSummary));
+    const size_t value_bytes = ARR_SIZE * sizeof(Value);
+    auto bucket = [](size_t n_key) { return std::min<size_t>(n_key * FILL_BUCKETS / ARR_SIZE, FILL_BUCKETS - 1); };
+    auto account = [&](int level, size_t n_key, bool augmented) {
+        usage.nodes[level]++;
+        usage.bytes[level] += sizeof(Node) + (augmented ? augment_bytes : 0);
+        usage.key_bytes[level] += n_key * sizeof(Key);
+        usage.fill[level][bucket(n_key)]++;
+    };
+
+    for (int l = 1; l < GetMaxHeight(); l++) {
+        for (Node* x = head_[l]->forward; x != nullptr; x = x->forward) {
+            account(l, x->N_key, x->counts != nullptr);
+            if (l > 1 || stale_counts_) continue;
+            for (int i = 0; i < x->N_key; i++) {
+                account(0, (x->counts != nullptr) ? x->counts[i] : x->next[i]->N_key, false);
+            }
+        }
+    }
+    Node* covered = stale_counts_ ? nullptr : FirstCovered(0);
+    for (Node* x = head_[0]->forward; x != nullptr && x != covered; x = x->forward) {
+        account(0, x->N_key, false);
+    }
+    for (int i = 0; covered != nullptr && i < pending_count_; i++) {
+        Node* x = pending_[(pending_head_ + i) % PENDING_SIZE];
+        if (compare_(x->keys[0], covered->keys[0]) > 0) account(0, x->N_key, false);
+    }
+
+    usage.head_bytes = kMaxHeight_ * sizeof(Node);
+    for (const View* view : snapshots_) {
+        usage.snapshot_bytes += view->copies_.size() * sizeof(Node);
+    }
+    usage.bytes[0] += value_nodes_ * value_bytes;
+    for (const auto& retired : retired_) {
+        Node* x = retired.second;
+        usage.snapshot_bytes += sizeof(Node) + (x->counts != nullptr ? augment_bytes : 0) + (x->values != nullptr ? value_bytes : 0);
+    }
+    usage.total_bytes = usage.head_bytes + usage.snapshot_bytes;
+    for (int l = 0; l < GetMaxHeight(); l++) {
+        usage.total_bytes += usage.bytes[l];
+    }
+    return usage;
+}
+
 template<typename Key>
 void SkipList<Key>::Array_utilization() {
     int m_height = GetMaxHeight() - 1;
@@ -2315,6 +4143,8 @@ void SkipList<Key>::Array_utilization() {
 
 template<typename Key>
 void SkipList<Key>::Insert_future(const Key& key) {
+    if (recorder_ != nullptr) recorder_->OnInsert(key);
+    DrainPending(PENDING_SIZE); // Descends through the upper levels only, which pending leaves are missing from
     Node* prev_[MAXHEIGHT];
     std::copy(std::begin(head_), std::end(head_), std::begin(prev_));
     int height = GetMaxHeight() - 1; // Using for search
@@ -2346,6 +4176,11 @@ void SkipList<Key>::Insert_future(const Key& key) {
     }
     
     // Do insert operation
+    PreserveSpine(prev_, 0);
+    SpineMark mark[MAXHEIGHT];
+    int marked = MarkSpill(prev_, mark);
+    LeafValues saved;
+    SaveValues(mark[0], &saved);
     int level = 0;
     while (true) {
         int stop_flag = 0;
@@ -2394,8 +4229,8 @@ void SkipList<Key>::Insert_future(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = key;
                         prev_[level]->forward->N_key++;
                         if (idx == -1) {
@@ -2435,9 +4270,9 @@ void SkipList<Key>::Insert_future(const Key& key) {
                         } else break;
                     } else {
                         Key update_key = prev_[level]->forward->keys[0];
-                        std::memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        std::memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        Memmove(&prev_[level]->forward->keys[idx+2], &prev_[level]->forward->keys[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        Memmove(&prev_[level]->forward->next[idx+2], &prev_[level]->forward->next[idx+1], (prev_[level]->forward->N_key - (idx+1)) * sizeof(Key));
+                        CountShift(); // Signal.Jin
                         prev_[level]->forward->keys[idx+1] = prev_[level-1]->forward->keys[0];
                         prev_[level]->forward->next[idx+1] = prev_[level-1]->forward;
                         prev_[level]->forward->N_key++;
@@ -2472,7 +4307,7 @@ void SkipList<Key>::Insert_future(const Key& key) {
                         Node* add_node = NewNode(key);
                         std::memcpy(add_node->keys+1, &prev_[level]->forward->keys[idx+1], (ARR_SIZE - (idx+1)) * sizeof(Key));
                         std::memset(&prev_[level]->forward->keys[idx+1], 0, (ARR_SIZE - (idx+1)) * sizeof(Key));
-                        shift_count++; // Signal.Jin
+                        CountShift(); // Signal.Jin
                         add_node->N_key += ARR_SIZE - (idx+1);
                         add_node->forward = prev_[level]->forward->forward;
                         prev_[level]->forward->N_key -= ARR_SIZE - (idx+1);
@@ -2512,8 +4347,8 @@ void SkipList<Key>::Insert_future(const Key& key) {
                             prev_[level]->keys[idx+1] = key;
                             prev_[level]->N_key++;    
                         } else {
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = key;
                             prev_[level]->N_key++;
                         }
@@ -2536,9 +4371,9 @@ void SkipList<Key>::Insert_future(const Key& key) {
                             prev_[level]->next[idx+1] = prev_[level-1];
                             prev_[level]->N_key++;
                         } else {
-                            std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                            shift_count++; // Signal.Jin
+                            Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                            CountShift(); // Signal.Jin
                             prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                             prev_[level]->next[idx+1] = prev_[level-1];
                             prev_[level]->N_key++;
@@ -2557,14 +4392,14 @@ void SkipList<Key>::Insert_future(const Key& key) {
 
                 //auto sp_start = Clock::now();
                 if (level == 0) { // Case 3-2-1: Insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     int idx = findMaxLessOrEqual(prev_[level]->keys, key);
                     if (idx == 0 && prev_[level]->keys[0] > key) idx = -1;
                     { 
                         if (idx == ARR_SIZE-1) {
                             if (prev_[level]->forward != nullptr && prev_[level]->forward->N_key < ARR_SIZE) {
                                 Key update_key = prev_[level]->forward->keys[0];
-                                std::memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (prev_[level]->forward->N_key) * sizeof(Key));
+                                Memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (prev_[level]->forward->N_key) * sizeof(Key));
                                 prev_[level]->forward->keys[0] = key;
                                 prev_[level]->forward->N_key++;
                                 for (int i = level+1; i < GetMaxHeight(); i++) {
@@ -2600,7 +4435,7 @@ void SkipList<Key>::Insert_future(const Key& key) {
                                 Node* add_node = NewNode(prev_[level]->keys[ARR_SIZE/2]);
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 add_node->N_key = ARR_SIZE/2;
                                 add_node->forward = prev_[level]->forward;
                                 prev_[level]->forward = add_node;
@@ -2610,8 +4445,8 @@ void SkipList<Key>::Insert_future(const Key& key) {
                                 } else {
                                     Key update_key = prev_[level]->keys[0];
                                     prev_[level]->N_key = ARR_SIZE / 2;
-                                    std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                    shift_count++; // Signal.Jin
+                                    Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->keys[idx+1] = key;
                                     prev_[level]->N_key++;
                                     if (idx == -1) {
@@ -2637,13 +4472,13 @@ void SkipList<Key>::Insert_future(const Key& key) {
                                 Node* add_node = NewNode(prev_[level]->keys[ARR_SIZE/2]);
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 add_node->N_key = ARR_SIZE/2 + 1;
                                 add_node->forward = prev_[level]->forward;
                                 prev_[level]->forward = add_node;
                                 prev_[level] = add_node;
-                                std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[idx+1] = key;
                                 level++;
                                 if (cur_height < level) {
@@ -2653,15 +4488,15 @@ void SkipList<Key>::Insert_future(const Key& key) {
                         }
                     }
                 } else { // Case 3-2-2: Not insert into H0
-                    split_count++; // Signal.Jin
+                    CountSplit(); // Signal.Jin
                     int idx = findMaxLessOrEqual(prev_[level]->keys, prev_[level-1]->keys[0]);
                     if (idx == 0 && prev_[level]->keys[0] > prev_[level-1]->keys[0]) idx = -1;
                     {
                         if (idx == ARR_SIZE-1) {
                             if (prev_[level]->forward != nullptr && prev_[level]->forward->N_key < ARR_SIZE) {
                                 Key update_key = prev_[level]->forward->keys[0];
-                                std::memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (prev_[level]->forward->N_key) * sizeof(Key));
-                                std::memmove(&prev_[level]->forward->next[1], &prev_[level]->forward->next[0], (prev_[level]->forward->N_key) * sizeof(Key));
+                                Memmove(&prev_[level]->forward->keys[1], &prev_[level]->forward->keys[0], (prev_[level]->forward->N_key) * sizeof(Key));
+                                Memmove(&prev_[level]->forward->next[1], &prev_[level]->forward->next[0], (prev_[level]->forward->N_key) * sizeof(Key));
                                 prev_[level]->forward->keys[0] = prev_[level-1]->keys[0];
                                 prev_[level]->forward->next[0] = prev_[level-1];
                                 prev_[level]->forward->N_key++;
@@ -2700,7 +4535,7 @@ void SkipList<Key>::Insert_future(const Key& key) {
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memcpy(add_node->next, &prev_[level]->next[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(prev_[level]->next[0]));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 for (int i = ARR_SIZE/2; i < ARR_SIZE; i++) {
                                     prev_[level]->next[i] = nullptr;
                                 }
@@ -2714,9 +4549,9 @@ void SkipList<Key>::Insert_future(const Key& key) {
                                 } else {
                                     Key update_key = prev_[level]->keys[0];
                                     prev_[level]->N_key = ARR_SIZE / 2;
-                                    std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                    std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
-                                    shift_count++; // Signal.Jin
+                                    Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                    Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
+                                    CountShift(); // Signal.Jin
                                     prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                                     prev_[level]->next[idx+1] = prev_[level-1];
                                     prev_[level]->N_key++;
@@ -2744,7 +4579,7 @@ void SkipList<Key>::Insert_future(const Key& key) {
                                 std::memcpy(add_node->keys, &prev_[level]->keys[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(Key));
                                 std::memcpy(add_node->next, &prev_[level]->next[ARR_SIZE/2], (ARR_SIZE/2) * sizeof(prev_[level]->next[0]));
                                 std::memset(&prev_[level]->keys[ARR_SIZE/2], 0, (ARR_SIZE/2) * sizeof(Key));
-                                shift_count++; // Signal.Jin
+                                CountShift(); // Signal.Jin
                                 for (int i = ARR_SIZE/2; i < ARR_SIZE; i++) {
                                     prev_[level]->next[i] = nullptr;
                                 }
@@ -2752,9 +4587,9 @@ void SkipList<Key>::Insert_future(const Key& key) {
                                 add_node->forward = prev_[level]->forward;
                                 prev_[level]->forward = add_node;
                                 prev_[level] = add_node;
-                                std::memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
-                                std::memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
-                                shift_count++; // Signal.Jin
+                                Memmove(&prev_[level]->keys[idx+2], &prev_[level]->keys[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(Key));
+                                Memmove(&prev_[level]->next[idx+2], &prev_[level]->next[idx+1], (prev_[level]->N_key - (idx+1)) * sizeof(prev_[level]->next[0]));
+                                CountShift(); // Signal.Jin
                                 prev_[level]->keys[idx+1] = prev_[level-1]->keys[0];
                                 prev_[level]->next[idx+1] = prev_[level-1];
                                 level++;
@@ -2774,4 +4609,6 @@ void SkipList<Key>::Insert_future(const Key& key) {
             break;
         }
     }
+    RestoreValues(mark[0], saved, key, Value());
+    RecountSpill(mark, marked);
 }
\ No newline at end of file
@@ -1,695 +1,767 @@
 #include <iostream>
 #include <set>
+#include <map>
 #include <random>
 #include <assert.h>
 
 #include <chrono>
 
-#include <fstream>
+#include <cctype>
 #include <string>
 #include <vector>
+#include <atomic>
+#include <thread>
 
 #include "zipf.h"
 #include "latest-generator.h"
 #include "skiplist.h"
-
-double calculatePercentile(const std::vector<double>& data, double percentile) {
-    std::vector<double> sortedData = data;
-    std::sort(sortedData.begin(), sortedData.end());
-
-    double index = (percentile / 100.0) * (sortedData.size() - 1);
-    int lowerIndex = static_cast<int>(index);
-    int upperIndex = std::min(lowerIndex + 1, static_cast<int>(sortedData.size() - 1));
-
-    double fractionalPart = index - lowerIndex;
-
-    return sortedData[lowerIndex] + fractionalPart * (sortedData[upperIndex] - sortedData[lowerIndex]);
+#include "sharded_skiplist.h"
+#include "perf_counters.h"
+#include "workload.h"
+#include "dataset.h"
+#include "results.h"
+#include "latency.h"
+#include "baselines.h"
+#include "trace.h"
+
+PerfCounters perf; // Hardware counters around the timed phases when run with DASL_PERF=1
+Results results; // Phases, latencies and index statistics written to DASL_RESULTS
+const uint64_t workload_seed = WorkloadSeed(); // Seed of the generated key and operation streams, DASL_SEED to override
+const TscClock tsc; // Per-operation timer, calibrated against steady_clock at startup
+size_t check_failures = 0; // Mismatches the consistency checks found, which fail the run
+
+// Inserts and lookups of the workloads that also run on the baselines (0-25):
+// DASL's default or named path on a SkipList, the adapter's only one otherwise
+inline void insertKey(SkipList<Key>& sl, Key key) { sl.Insert_usplit(key); }
+template<typename Index> inline void insertKey(Index& index, Key key) { index.Insert(key); }
+template<typename Path> inline void insertKey(SkipList<Key>& sl, Key key, Path path) { (sl.*path)(key); }
+template<typename Index, typename Path> inline void insertKey(Index& index, Key key, Path) { index.Insert(key); }
+template<typename Path> inline bool containsKey(SkipList<Key>& sl, Key key, Path path) { return (sl.*path)(key); }
+template<typename Index, typename Path> inline bool containsKey(Index& index, Key key, Path) { return index.Contains(key); }
+
+// Index statistics recorded after a run: DASL's structure, a baseline's size
+void recordIndex(SkipList<Key>& sl) {
+    results.Index("height", sl.print_height());
+    results.Index("splits", sl.print_split_cnt());
+    results.Index("shifts", sl.print_shift());
+    results.Index("keys", sl.Size());
+    results.Index("memory_bytes", sl.MemoryStats().total_bytes);
 }
 
-void fb(SkipList<Key>& sl) {
-    // Load keys from the 'fb' dataset
-    std::string file_path = "./dataset/fb.txt";
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << file_path << std::endl;
-        return;
-    }
-
-    std::vector<Key> numbers;
-    std::string line;
-    while (std::getline(file, line)) {
-        Key number = std::stoull(line);
-        numbers.push_back(number);
-    }
-    file.close();
-
-    // Random generator for selecting keys
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, numbers.size() - 1);
-
-    // Insert keys from dataset
-    auto w_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
-        sl.Insert_usplit(key);
-    }
-    auto w_end = Clock::now();
-    std::cout << "After Insert\n";
+template<typename Index>
+void recordIndex(Index& index) {
+    results.Index("keys", index.Size());
+}
 
-    // Search keys from dataset
-    auto r_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
-        sl.Contains(key);
+// Phases of each index's run, passed on to the results and printed side by
+// side once a workload has run on every index
+class Comparison : public PhaseSink {
+   public:
+    explicit Comparison(PhaseSink* next) : next_(next) {}
+
+    void Begin(const char* structure) { runs_.push_back({structure, {}}); }
+    void Phase(const char* phase, long ops, double seconds) override {
+        if (!runs_.empty()) runs_.back().phases.push_back({phase, ops, seconds});
+        next_->Phase(phase, ops, seconds);
+    }
+    void Counter(const char* name, double per_op) override { next_->Counter(name, per_op); }
+
+    void Print(const std::string& name) const {
+        printf("\n[Comparison - %s]\n", name.c_str());
+        for (const Run& run : runs_) {
+            printf("%-18s", run.structure);
+            for (size_t i = 0; i < run.phases.size(); i++) {
+                const PhaseTime& phase = run.phases[i];
+                printf("%s%s = %.2lf ms (%.2lf Mops/s)", i ? ", " : "", phase.name.c_str(), phase.seconds * 1e3, phase.seconds > 0 ? phase.ops / phase.seconds * 1e-6 : 0.0);
+            }
+            printf("\n");
+        }
     }
-    auto r_end = Clock::now();
 
-    // Calculate and display times
-    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
-    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
-    printf("\n[Real-fb] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
-}
+   private:
+    struct PhaseTime {
+        std::string name;
+        long ops;
+        double seconds;
+    };
+    struct Run {
+        const char* structure;
+        std::vector<PhaseTime> phases;
+    };
 
-void books(SkipList<Key>& sl) {
-    // Load keys from the 'books' dataset
-    std::string file_path = "./dataset/books.txt";
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << file_path << std::endl;
-        return;
-    }
+    PhaseSink* next_;
+    std::vector<Run> runs_;
+};
 
-    std::vector<Key> numbers;
-    std::string line;
-    while (std::getline(file, line)) {
-        Key number = std::stoull(line);
-        numbers.push_back(number);
-    }
-    file.close();
+Comparison comparison(&results);
 
-    // Random generator for selecting keys
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, numbers.size() - 1);
+// Inserts write keys and looks up read keys, both sampled from the size keys
+// of a dataset
+template<typename Index>
+void runDataset(const std::string& label, const Key* data, size_t size, size_t write, size_t read, Index& sl) {
+    // Keys selected at random from the dataset, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> keys = SampleKeys(gen, write, data, size);
 
     // Insert keys from dataset
+    perf.Begin();
     auto w_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
-        sl.Insert_usplit(key);
+    for (std::size_t i = 0; i < write; ++i) {
+        Key key = keys[i];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Search keys from dataset
+    keys = SampleKeys(gen, read, data, size);
+    perf.Begin();
     auto r_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
+    for (std::size_t i = 0; i < read; ++i) {
+        Key key = keys[i];
         sl.Contains(key);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate and display times
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
-    printf("\n[Real-books] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[%s] Insertion = %.2lf ms, Lookup = %.2lf ms\n", label.c_str(), w_time, r_time);
 }
 
-void wiki(SkipList<Key>& sl) {
-    // Load keys from the 'wiki' dataset
-    std::string file_path = "./dataset/wiki.txt";
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << file_path << std::endl;
+template<typename Index>
+void RealWorld(const std::string& name, Index& sl) {
+    // Map keys of the dataset, converting its text file on first use
+    Dataset dataset;
+    if (!dataset.Load(name) || dataset.size() == 0) {
+        std::cerr << "Failed to load dataset: " << DATASET_DIR << name << ".bin" << std::endl;
         return;
     }
+    runDataset("Real-" + name, dataset.data(), dataset.size(), dataset.size(), dataset.size(), sl);
+}
 
-    std::vector<Key> numbers;
-    std::string line;
-    while (std::getline(file, line)) {
-        Key number = std::stoull(line);
-        numbers.push_back(number);
-    }
-    file.close();
-
-    // Random generator for selecting keys
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, numbers.size() - 1);
-
-    // Insert keys from dataset
-    auto w_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
-        sl.Insert_usplit(key);
-    }
-    auto w_end = Clock::now();
-    std::cout << "After Insert\n";
+template<typename Index>
+void fb(Index& sl) {
+    RealWorld("fb", sl);
+}
 
-    // Search keys from dataset
-    auto r_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
-        sl.Contains(key);
-    }
-    auto r_end = Clock::now();
+template<typename Index>
+void books(Index& sl) {
+    RealWorld("books", sl);
+}
 
-    // Calculate and display times
-    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
-    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
-    printf("\n[Real-wiki] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+template<typename Index>
+void wiki(Index& sl) {
+    RealWorld("wiki", sl);
 }
 
-void osm(SkipList<Key>& sl) {
-    // Load keys from the 'osm' dataset
-    std::string file_path = "./dataset/osm.txt";
-    std::ifstream file(file_path);
-    if (!file.is_open()) {
-        std::cerr << "Failed to open file: " << file_path << std::endl;
-        return;
-    }
+template<typename Index>
+void osm(Index& sl) {
+    RealWorld("osm", sl);
+}
 
-    std::vector<Key> numbers;
-    std::string line;
-    while (std::getline(file, line)) {
-        Key number = std::stoull(line);
-        numbers.push_back(number);
-    }
-    file.close();
+// Synthetic stand-ins: write keys shaped like the dataset, sampled as in the
+// real-world benchmarks
+void SyntheticDataset(const std::string& name, std::vector<Key> (*generate)(std::mt19937_64&, size_t), const int write, const int read, SkipList<Key>& sl) {
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> keys = generate(gen, std::max(write, 1));
+    runDataset("Synthetic-" + name, keys.data(), keys.size(), write, read, sl);
+}
 
-    // Random generator for selecting keys
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, numbers.size() - 1);
+void SyntheticFb(const int write, const int read, SkipList<Key>& sl) {
+    SyntheticDataset("fb", ClusteredKeys, write, read, sl);
+}
 
-    // Insert keys from dataset
-    auto w_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
-        sl.Insert_usplit(key);
-    }
-    auto w_end = Clock::now();
-    std::cout << "After Insert\n";
+void SyntheticBooks(const int write, const int read, SkipList<Key>& sl) {
+    SyntheticDataset("books", LognormalKeys, write, read, sl);
+}
 
-    // Search keys from dataset
-    auto r_start = Clock::now();
-    for (std::size_t i = 0; i < numbers.size(); ++i) {
-        Key key = numbers[distr(gen)];
-        sl.Contains(key);
-    }
-    auto r_end = Clock::now();
+void SyntheticWiki(const int write, const int read, SkipList<Key>& sl) {
+    SyntheticDataset("wiki", TimestampKeys, write, read, sl);
+}
 
-    // Calculate and display times
-    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
-    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
-    printf("\n[Real-osm] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+void SyntheticOsm(const int write, const int read, SkipList<Key>& sl) {
+    SyntheticDataset("osm", MortonKeys, write, read, sl);
 }
 
-void YCSBWorkloadA(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void YCSBWorkloadA(const int write, const int read, Index& sl) {
     // YCSB Workload A: Read-heavy (50% reads, 50% writes)
-    init_zipf_generator(0, write);
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
+    std::vector<uint8_t> r_ops = MixedOps(gen, read, 50, kOpRead, kOpInsert);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = (nextValue() % (write)) + 1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 0; i < read; i++) {
-        Key Zkey = (nextValue() % (read)) + 1;
+        Key Zkey = r_keys[i];
 
-        int next_op = rand() % 100;
-
-        if (next_op < 50) {
+        if (r_ops[i] == kOpRead) {
             sl.Contains(Zkey);
         } else {
-            sl.Insert_usplit(Zkey);
+            insertKey(sl, Zkey);
         }
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[YCSB-A] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[YCSB-A] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void YCSBWorkloadB(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void YCSBWorkloadB(const int write, const int read, Index& sl) {
     // YCSB Workload B: Read-mostly (95% reads, 5% writes)
-    init_zipf_generator(0, write);
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
+    std::vector<uint8_t> r_ops = MixedOps(gen, read, 95, kOpRead, kOpInsert);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = (nextValue() % (write)) + 1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key Zkey = (nextValue() % (read)) + 1;
-
-        int next_op = rand() % 100;
+        Key Zkey = r_keys[i - 1];
 
-        if (next_op < 95) {
+        if (r_ops[i - 1] == kOpRead) {
             sl.Contains(Zkey);
         } else {
-            sl.Insert_usplit(Zkey);
+            insertKey(sl, Zkey);
         }
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[YCSB-B] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[YCSB-B] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void YCSBWorkloadC(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void YCSBWorkloadC(const int write, const int read, Index& sl) {
     // YCSB Workload C: Read-only (100% reads)
-    init_zipf_generator(0, write);
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = (nextValue() % (write)) + 1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key Zkey = (nextValue() % (read)) + 1;
+        Key Zkey = r_keys[i - 1];
         sl.Contains(Zkey);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[YCSB-C] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[YCSB-C] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void YCSBWorkloadD(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void YCSBWorkloadD(const int write, const int read, Index& sl) {
     // YCSB Workload D: Read-latest (95% reads, 5% inserts)
-    init_latestgen(write);
-    init_zipf_generator(0, write);
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = LatestKeys(gen, write, write, write);
+    std::vector<Key> r_keys = LatestKeys(gen, read, write, read);
+    std::vector<uint8_t> r_ops = MixedOps(gen, read, 95, kOpRead, kOpInsert);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = next_value_latestgen() % write + 1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key Zkey = next_value_latestgen() % read + 1;
-
-        int next_op = rand() % 100;
+        Key Zkey = r_keys[i - 1];
 
-        if (next_op < 95) {
+        if (r_ops[i - 1] == kOpRead) {
             sl.Contains(Zkey);
         } else {
-            sl.Insert_usplit(Zkey);
+            insertKey(sl, Zkey);
         }
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[YCSB-D] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[YCSB-D] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void YCSBWorkloadE(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void YCSBWorkloadE(const int write, const int read, Index& sl) {
     // YCSB Workload E: Short ranges (95% scans, 5% inserts)
-    init_zipf_generator(0, write);
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
+    std::vector<uint8_t> r_ops = MixedOps(gen, read, 95, kOpScan, kOpInsert);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = (nextValue() % (write)) + 1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Scan keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key Zkey = (nextValue() % (read)) + 1;
-
-        int next_op = rand() % 100;
+        Key Zkey = r_keys[i - 1];
 
-        if (next_op < 95) {
+        if (r_ops[i - 1] == kOpScan) {
             sl.Scan(Zkey, 100);
         } else {
-            sl.Insert_usplit(Zkey);
+            insertKey(sl, Zkey);
         }
     }
     auto r_end = Clock::now();
+    perf.End("scan", read);
 
     // Calculate scan time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[YCSB-E] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[YCSB-E] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void YCSBWorkloadF(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void YCSBWorkloadF(const int write, const int read, Index& sl) {
     // YCSB Workload F: Read-modify-write (50% reads, 50% writes)
-    init_zipf_generator(0, write);
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
+    std::vector<uint8_t> r_ops = MixedOps(gen, read, 50, kOpRead, kOpReadModifyWrite);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = (nextValue() % (write)) + 1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Read-modify-write for keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key Zkey = (nextValue() % (read)) + 1;
-
-        int next_op = rand() % 100;
+        Key Zkey = r_keys[i - 1];
 
-        if (next_op < 50) {
+        if (r_ops[i - 1] == kOpRead) {
             sl.Contains(Zkey);
         } else {
             sl.Contains(Zkey);
-            sl.Insert_usplit(Zkey);
+            insertKey(sl, Zkey);
         }
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate operation time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[YCSB-F] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[YCSB-F] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void Zipfian(const int write, const int read, SkipList<Key>& sl) {
-    // Zipfian distribution generator
-    init_zipf_generator(0, write);
+template<typename Index>
+void Zipfian(const int write, const int read, Index& sl) {
+    // Zipfian distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
 
     // Insert keys following Zipfian distribution
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = nextValue() % write+1;        
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];        
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys following Zipfian distribution
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key key = nextValue() % read+1;
+        Key key = r_keys[i - 1];
         sl.Contains(key);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[Zipfian] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[Zipfian] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void Uniform(const int write, const int read, SkipList<Key>& sl) {
-    // Uniformly distributed random generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(1, write);
+template<typename Index>
+void Uniform(const int write, const int read, Index& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 2, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 2, write + 1);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        sl.Insert_usplit(distr(gen)+1);
+        insertKey(sl, w_keys[i - 1]);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for random keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        sl.Contains(distr(gen)+1);
+        sl.Contains(r_keys[i - 1]);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[Uniform] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[Uniform] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void RevSequential(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void RevSequential(const int write, const int read, Index& sl) {
     // Insert keys reverse sequentially
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = write; i > 0; i--) {
-        sl.Insert_usplit(i);
+        insertKey(sl, i);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys reverse sequentially
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = read; i > 0; i--) {
         sl.Contains(i);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[Rev-Sequential] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[Rev-Sequential] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void Sequential(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void Sequential(const int write, const int read, Index& sl) {
     // Insert keys sequentially
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        sl.Insert_usplit(i);
+        insertKey(sl, i);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys sequentially
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
         sl.Contains(i);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[Sequential] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[Sequential] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void Zipfian_latency(const int write, const int read, SkipList<Key>& sl) {
-    // Vectors to store write and read latencies
-    std::vector<double> w_lat;
-    std::vector<double> r_lat;
+template<typename Index>
+void Zipfian_latency(const int write, const int read, Index& sl) {
+    // Histograms of write and read latencies, in TSC ticks
+    LatencyHistogram w_lat;
+    LatencyHistogram r_lat;
 
-    // Initialize Zipfian generator
-    init_zipf_generator(0, write);
+    // Zipfian distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
 
     // Measure write latencies
+    perf.Begin();
     for (int i = 1; i <= write; ++i) {
-        Key key = nextValue() % write + 1;
-        auto w_start = Clock::now();
-        sl.Insert_usplit(key);
-        auto w_end = Clock::now();
-        double w_time = std::chrono::duration_cast<std::chrono::nanoseconds>(w_end - w_start).count();
-        w_lat.push_back(w_time);
+        Key key = w_keys[i - 1];
+        uint64_t w_start = tsc.Start();
+        insertKey(sl, key);
+        w_lat.RecordSpan(w_start, tsc.Stop());
     }
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Measure read latencies
+    perf.Begin();
     for (int i = 1; i <= read; ++i) {
-        Key key = nextValue() % read + 1;
-        auto r_start = Clock::now();
+        Key key = r_keys[i - 1];
+        uint64_t r_start = tsc.Start();
         sl.Contains(key);
-        auto r_end = Clock::now();
-        double r_time = std::chrono::duration_cast<std::chrono::nanoseconds>(r_end - r_start).count();
-        r_lat.push_back(r_time);
+        r_lat.RecordSpan(r_start, tsc.Stop());
     }
+    perf.End("lookup", read);
 
     // Calculate and print write latencies percentiles
     std::vector<double> write_percentiles = {50, 99, 99.9, 99.99, 99.999};
     std::cout << "\n[Zipfian Latency] Insertion: ";
     for (double p : write_percentiles) {
-        printf(" %.2lf = %.lf", p, calculatePercentile(w_lat, p));
+        double latency = tsc.ToNs(w_lat.Percentile(p));
+        printf(" %.2lf = %.lf", p, latency);
+        results.Percentile("insert", p, latency);
     }
 
     // Calculate and print read latencies percentiles
     std::cout << "\n[Zipfian Latency] Lookup: ";
     for (double p : write_percentiles) {
-        printf(" %.2lf = %.lf", p, calculatePercentile(r_lat, p));
+        double latency = tsc.ToNs(r_lat.Percentile(p));
+        printf(" %.2lf = %.lf", p, latency);
+        results.Percentile("lookup", p, latency);
     }
     std::cout << std::endl;
 }
 
-void Uniform_latency(const int write, const int read, SkipList<Key>& sl) {
-    // Vectors to store write and read latencies
-    std::vector<double> w_lat;
-    std::vector<double> r_lat;
+// Uniform keys inserted through path, which the baselines ignore for their
+// single insert, with every insert and lookup timed on its own
+template<typename Index, typename Path>
+void uniformLatency(const char* label, const int write, const int read, Index& sl, Path path) {
+    // Histograms of write and read latencies, in TSC ticks
+    LatencyHistogram w_lat;
+    LatencyHistogram r_lat;
 
-    // Uniformly distributed random generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, write);
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write + 1);
 
     // Measure write latencies
+    perf.Begin();
     for (int i = 1; i <= write; ++i) {
-        Key key = distr(gen) + 1;
-        auto w_start = Clock::now();
-        sl.Insert_usplit(key);
-        auto w_end = Clock::now();
-        double w_time = std::chrono::duration_cast<std::chrono::nanoseconds>(w_end - w_start).count();
-        w_lat.push_back(w_time);
+        Key key = w_keys[i - 1];
+        uint64_t w_start = tsc.Start();
+        insertKey(sl, key, path);
+        w_lat.RecordSpan(w_start, tsc.Stop());
     }
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Measure read latencies
+    perf.Begin();
     for (int i = 1; i <= read; ++i) {
-        Key key = distr(gen) + 1;
-        auto r_start = Clock::now();
+        Key key = r_keys[i - 1];
+        uint64_t r_start = tsc.Start();
         sl.Contains(key);
-        auto r_end = Clock::now();
-        double r_time = std::chrono::duration_cast<std::chrono::nanoseconds>(r_end - r_start).count();
-        r_lat.push_back(r_time);
+        r_lat.RecordSpan(r_start, tsc.Stop());
     }
+    perf.End("lookup", read);
 
     // Calculate and print write latencies percentiles
     std::vector<double> write_percentiles = {50, 99, 99.9, 99.99, 99.999};
-    std::cout << "\n[Uniform Latency] Insertion: ";
+    printf("\n[%s] Insertion: ", label);
     for (double p : write_percentiles) {
-        printf(" %.2lf = %.lf", p, calculatePercentile(w_lat, p));
+        double latency = tsc.ToNs(w_lat.Percentile(p));
+        printf(" %.2lf = %.lf", p, latency);
+        results.Percentile("insert", p, latency);
     }
 
     // Calculate and print read latencies percentiles
-    std::cout << "\n[Uniform Latency] Lookup: ";
+    printf("\n[%s] Lookup: ", label);
     for (double p : write_percentiles) {
-        printf(" %.2lf = %.lf", p, calculatePercentile(r_lat, p));
+        double latency = tsc.ToNs(r_lat.Percentile(p));
+        printf(" %.2lf = %.lf", p, latency);
+        results.Percentile("lookup", p, latency);
     }
     std::cout << std::endl;
 }
 
-void Sequential_latency(const int write, const int read, SkipList<Key>& sl) {
-    // Vectors to store write and read latencies
-    std::vector<double> w_lat;
-    std::vector<double> r_lat;
+template<typename Index>
+void Uniform_latency(const int write, const int read, Index& sl) {
+    uniformLatency("Uniform Latency", write, read, sl, &SkipList<Key>::Insert_usplit);
+}
+
+// Uniform latencies with upper-level maintenance deferred by Insert_lazy
+void Lazy_latency(const int write, const int read, SkipList<Key>& sl) {
+    uniformLatency("Lazy Latency", write, read, sl, &SkipList<Key>::Insert_lazy);
+}
+
+template<typename Index>
+void Sequential_latency(const int write, const int read, Index& sl) {
+    // Histograms of write and read latencies, in TSC ticks
+    LatencyHistogram w_lat;
+    LatencyHistogram r_lat;
 
     // Measure write latencies
+    perf.Begin();
     for (int i = 1; i <= write; ++i) {
-        auto w_start = Clock::now();
-        sl.Insert_usplit(i);
-        auto w_end = Clock::now();
-        double w_time = std::chrono::duration_cast<std::chrono::nanoseconds>(w_end - w_start).count();
-        w_lat.push_back(w_time);
+        uint64_t w_start = tsc.Start();
+        insertKey(sl, i);
+        w_lat.RecordSpan(w_start, tsc.Stop());
     }
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Measure read latencies
+    perf.Begin();
     for (int i = 1; i <= read; ++i) {
-        auto r_start = Clock::now();
+        uint64_t r_start = tsc.Start();
         sl.Contains(i);
-        auto r_end = Clock::now();
-        double r_time = std::chrono::duration_cast<std::chrono::nanoseconds>(r_end - r_start).count();
-        r_lat.push_back(r_time);
+        r_lat.RecordSpan(r_start, tsc.Stop());
     }
+    perf.End("lookup", read);
 
     // Calculate and print write latencies percentiles
     std::vector<double> write_percentiles = {50, 99, 99.9, 99.99, 99.999};
     std::cout << "\n[Sequential Latency] Insertion: ";
     for (double p : write_percentiles) {
-        printf(" %.2lf = %.lf ns", p, calculatePercentile(w_lat, p));
+        double latency = tsc.ToNs(w_lat.Percentile(p));
+        printf(" %.2lf = %.lf ns", p, latency);
+        results.Percentile("insert", p, latency);
     }
 
     // Calculate and print read latencies percentiles
     std::cout << "\n[Sequential Latency] Lookup: ";
     for (double p : write_percentiles) {
-        printf(" %.2lf = %.lf ns", p, calculatePercentile(r_lat, p));
+        double latency = tsc.ToNs(r_lat.Percentile(p));
+        printf(" %.2lf = %.lf ns", p, latency);
+        results.Percentile("lookup", p, latency);
     }
     std::cout << std::endl;
 }
 
-void Uniform_Scan(const int write, const int read, SkipList<Key> &sl) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, write);
+template<typename Index>
+void Uniform_Scan(const int write, const int read, Index& sl) {
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write + 1);
 
+    perf.Begin();
     auto w_start = Clock::now();
     for(int i = 1; i <= write; i++) {
-        Key key = distr(gen)+1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     printf("After Insert\n");
+    perf.Begin();
     auto r_start = Clock::now();
     for(int i = 1; i <= read; i++) {
-        Key key = distr(gen)+1;
+        Key key = r_keys[i - 1];
         sl.Scan(key, 100);
     }
     auto r_end = Clock::now();
+    perf.End("scan", read);
 
     float r_time, w_time;
     r_time = std::chrono::duration_cast<std::chrono::nanoseconds>(r_end - r_start).count() * 0.001;
@@ -697,256 +769,1215 @@ void Uniform_Scan(const int write, const int read, SkipList<Key> &sl) {
     printf("\n[Uniform-Scan] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
 }
 
-void Array(const int write, const int read, SkipList<Key>& sl) {
-    // Uniformly distributed random generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, write);
+template<typename Index>
+void Array(const int write, const int read, Index& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write + 1);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = distr(gen)+1;
-        sl.Insert_Array(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key, &SkipList<Key>::Insert_Array);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search random keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key key = distr(gen)+1;
-        sl.Contains_Raise(key);
+        Key key = r_keys[i - 1];
+        containsKey(sl, key, &SkipList<Key>::Contains_Raise);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[+Array] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[+Array] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void Raise(const int write, const int read, SkipList<Key>& sl) {
-    // Uniformly distributed random generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, write);
+template<typename Index>
+void Raise(const int write, const int read, Index& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write + 1);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = distr(gen)+1;
-        sl.Insert_Raise(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key, &SkipList<Key>::Insert_Raise);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search random keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key key = distr(gen)+1;
-        sl.Contains_Raise(key);
+        Key key = r_keys[i - 1];
+        containsKey(sl, key, &SkipList<Key>::Contains_Raise);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[+Raise] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[+Raise] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void Search(const int write, const int read, SkipList<Key>& sl) {
-    // Uniformly distributed random generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, write);
+template<typename Index>
+void Search(const int write, const int read, Index& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write + 1);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = distr(gen)+1;
-        sl.Insert_Search(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key, &SkipList<Key>::Insert_Search);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search random keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key key = distr(gen)+1;
+        Key key = r_keys[i - 1];
         sl.Contains(key);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[+Search] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[+Search] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void Split(const int write, const int read, SkipList<Key>& sl) {
-    // Uniformly distributed random generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, write);
+template<typename Index>
+void Split(const int write, const int read, Index& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write + 1);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = distr(gen)+1;
-        sl.Insert_usplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search random keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key key = distr(gen)+1;
+        Key key = r_keys[i - 1];
         sl.Contains(key);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[+Split] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[+Split] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void EvenSplitSequential(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void EvenSplitSequential(const int write, const int read, Index& sl) {
     // Insert keys sequentially
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        sl.Insert_esplit(i);
+        insertKey(sl, i, &SkipList<Key>::Insert_esplit);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys sequentially
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
         sl.Contains(i);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[EvenSplit Sequential] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[EvenSplit Sequential] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void EvenSplitRevSequential(const int write, const int read, SkipList<Key>& sl) {
+template<typename Index>
+void EvenSplitRevSequential(const int write, const int read, Index& sl) {
     // Insert keys reverse sequentially
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = write; i > 0; i--) {
-        sl.Insert_esplit(i);
+        insertKey(sl, i, &SkipList<Key>::Insert_esplit);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys reverse sequentially
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = read; i > 0; i--) {
         sl.Contains(i);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[EvenSplit - RevSequential] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[EvenSplit - RevSequential] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void EvenSplitUniform(const int write, const int read, SkipList<Key>& sl) {
-    // Uniformly distributed random generator
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<int> distr(0, write);
+template<typename Index>
+void EvenSplitUniform(const int write, const int read, Index& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write + 1);
 
     // Insert random keys
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = distr(gen)+1;
-        sl.Insert_esplit(key);
+        Key key = w_keys[i - 1];
+        insertKey(sl, key, &SkipList<Key>::Insert_esplit);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search random keys
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key key = distr(gen)+1;
+        Key key = r_keys[i - 1];
         sl.Contains(key);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[EvenSplit Uniform] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[EvenSplit Uniform] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
 }
 
-void EvenSplitZipfian(const int write, const int read, SkipList<Key>& sl) {
-    // Zipfian distribution generator
-    init_zipf_generator(0, write);
+template<typename Index>
+void EvenSplitZipfian(const int write, const int read, Index& sl) {
+    // Zipfian distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = ZipfianKeys(gen, write, write, write);
+    std::vector<Key> r_keys = ZipfianKeys(gen, read, write, read);
 
     // Insert keys following Zipfian distribution
+    perf.Begin();
     auto w_start = Clock::now();
     for (int i = 1; i <= write; ++i) {
-        Key key = nextValue() % write+1;        
-        sl.Insert_esplit(key);
+        Key key = w_keys[i - 1];        
+        insertKey(sl, key, &SkipList<Key>::Insert_esplit);
     }
     auto w_end = Clock::now();
+    perf.End("insert", write);
     std::cout << "After Insert\n";
 
     // Calculate insertion time
     float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
 
     // Search for keys following Zipfian distribution
+    perf.Begin();
     auto r_start = Clock::now();
     for (int i = 1; i <= read; ++i) {
-        Key key = nextValue() % read+1;
+        Key key = r_keys[i - 1];
         sl.Contains(key);
     }
     auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate search time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[EvenSplit Zipfian] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
+}
+
+void AdaptiveSplitMixed(const int write, const int read, SkipList<Key>& sl) {
+    // Keys alternating sequential bursts and uniform updates, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, write);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write);
+    const int phase = std::max(write / 10, 1);
+    Key seq_key = write;
+    for (int i = 1; i <= write; ++i) {
+        if ((i / phase) % 2 == 0) w_keys[i - 1] = ++seq_key;
+    }
+
+    // Insert keys alternating sequential bursts and random updates
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 1; i <= write; ++i) {
+        sl.Insert_asplit(w_keys[i - 1]);
+    }
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
+
+    // Search random keys
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read; ++i) {
+        sl.Contains(r_keys[i - 1]);
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate search time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[AdaptiveSplit Mixed] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
+    printf("Split = %d, Shift = %d\n", sl.print_split_cnt(), sl.print_shift());
+}
+
+void Compaction(const int write, const int read, SkipList<Key>& sl) {
+    // Uniformly distributed keys, generated before timing; the leaves their
+    // uneven splits leave are each too full to merge with a sibling
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 1, 4 * (Key)std::max(write, 1));
+    std::vector<Key> r_keys = SampleKeys(gen, read, w_keys.data(), w_keys.size());
+
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 1; i <= write; ++i) {
+        sl.Insert_usplit(w_keys[i - 1]);
+    }
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
+
+    // Compact incrementally until a pass frees nothing
+    int freed = 0;
+    auto c_start = Clock::now();
+    while (true) {
+        int n = sl.Compact(1024);
+        if (n == 0) break;
+        freed += n;
+    }
+    auto c_end = Clock::now();
+    float c_time = std::chrono::duration_cast<std::chrono::microseconds>(c_end - c_start).count() * 0.001;
+    results.Phase("compact", freed, c_time * 0.001);
+
+    // Search for inserted keys
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read; ++i) {
+        sl.Contains(r_keys[i - 1]);
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate search time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[Compaction] Insertion = %.2lf ms, Compaction = %.2lf ms, Lookup = %.2lf ms\n", w_time, c_time, r_time);
+    printf("Freed nodes = %d\n", freed);
+}
+
+void BatchUniform(const int write, const int read, SkipList<Key>& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 2, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 2, write + 1);
+
+    // Insert random keys in micro-batches
+    const int batch = 4096;
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 0; i < write; i += batch) {
+        int n = std::min(batch, write - i);
+        sl.InsertBatch(w_keys.data() + i, n);
+    }
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
+
+    // Search random keys
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read; ++i) {
+        sl.Contains(r_keys[i - 1]);
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate search time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[Batch Uniform] Insertion = %.2lf ms, Lookup = %.2lf ms\n", w_time, r_time);
+}
+
+void BulkLoad(const int write, const int read, SkipList<Key>& sl) {
+    // Generate unsorted keys outside the timed region
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> keys = UniformKeys(gen, write, 2, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 2, write + 1);
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // Sort and build the whole index bottom-up
+    perf.Begin();
+    auto w_start = Clock::now();
+    sl.ParallelBulkLoad(keys.data(), keys.size(), threads);
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate load time
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
+
+    // Search random keys
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read; ++i) {
+        sl.Contains(r_keys[i - 1]);
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate search time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[Bulk Load - %d threads] Insertion = %.2lf ms, Lookup = %.2lf ms\n", threads, w_time, r_time);
+}
+
+void ShardedUniform(const int write, const int read, SkipList<Key>& sl) {
+    // One range-partitioned shard per core
+    int shards = std::max(1u, std::thread::hardware_concurrency());
+    ShardedSkipList<Key> ssl(shards, write + 1);
+
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 2, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 2, write + 1);
+
+    // Insert random keys
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 1; i <= write; ++i) {
+        ssl.Insert(w_keys[i - 1]);
+    }
+    ssl.Sync();
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
+
+    // Search random keys
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read; ++i) {
+        ssl.Contains(r_keys[i - 1]);
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate search time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[Sharded Uniform - %d shards] Insertion = %.2lf ms, Lookup = %.2lf ms\n", ssl.print_shards(), w_time, r_time);
+}
+
+void SnapshotScan(const int write, const int read, SkipList<Key>& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 2, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 2, write + 1);
+
+    // Load the list before taking the snapshot
+    for (int i = 1; i <= write; ++i) {
+        sl.Insert_usplit(w_keys[i - 1]);
+    }
+    const SkipList<Key>::View* view = sl.Snapshot();
+
+    // Scan the snapshot in chunks while random keys keep being inserted
+    const size_t chunk = 1000;
+    std::vector<Key> out(chunk);
+    Key from = 0;
+    size_t scanned = 0;
+    float w_time = 0, r_time = 0;
+    for (int i = 1; i <= read; ++i) {
+        auto w_start = Clock::now();
+        sl.Insert_usplit(r_keys[i - 1]);
+        auto w_end = Clock::now();
+        w_time += std::chrono::duration_cast<std::chrono::nanoseconds>(w_end - w_start).count() * 0.001;
+
+        if (i % 100 == 0) {
+            auto r_start = Clock::now();
+            size_t n = view->Scan(from, chunk, out.data());
+            auto r_end = Clock::now();
+            r_time += std::chrono::duration_cast<std::chrono::nanoseconds>(r_end - r_start).count() * 0.001;
+            scanned += n;
+            from = (n == chunk) ? out[n - 1] + 1 : 0;
+        }
+    }
+    size_t copies = view->print_copies();
+    sl.ReleaseSnapshot(view);
+    results.Phase("insert", read, w_time * 1e-6);
+    results.Phase("scan", read / 100, r_time * 1e-6);
+
+    // Display results
+    printf("\n[Snapshot Scan - %zu keys scanned, %zu nodes copied] Insertion = %.2lf µs, Scan = %.2lf µs\n", scanned, copies, w_time, r_time);
+}
+
+void OrderStatistics(const int write, const int read, SkipList<Key>& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 2, write + 1);
+    std::vector<Key> r_keys = UniformKeys(gen, read / 2, 2, write + 1);
+
+    // Insert random keys
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 1; i <= write; ++i) {
+        sl.Insert_usplit(w_keys[i - 1]);
+    }
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
+
+    // Rank of random keys, then select random positions (uniform sampling)
+    size_t size = sl.Size();
+    std::vector<Key> positions = UniformKeys(gen, read - read / 2, 0, size - 1);
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read / 2; ++i) {
+        sl.Rank(r_keys[i - 1]);
+    }
+    for (int i = 1; i <= read - read / 2; ++i) {
+        sl.Select(positions[i - 1]);
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate query time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[Order Statistics - %zu keys, p99 = %lu] Insertion = %.2lf ms, Rank/Select = %.2lf ms\n", size, (unsigned long)sl.Select(size * 99 / 100), w_time, r_time);
+}
+
+void RangeAggregate(const int write, const int read, SkipList<Key>& sl) {
+    // Uniformly distributed keys and values, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 2, write + 1);
+    std::vector<Key> w_values = UniformKeys(gen, write, 1, 1000);
+    std::vector<Key> r_keys = UniformKeys(gen, read, 1, write);
+
+    // Insert random keys with their values
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 1; i <= write; ++i) {
+        sl.Put(w_keys[i - 1], w_values[i - 1]);
+    }
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001;
+
+    // Aggregate random ranges each spanning 10% of the key space
+    Key width = write / 10 + 1;
+    size_t covered = 0;
+    Value value_sum = 0;
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read; ++i) {
+        Key lo = r_keys[i - 1];
+        SkipList<Key>::Summary summary = sl.Aggregate(lo, lo + width);
+        covered += summary.count;
+        value_sum += summary.sum;
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
+
+    // Calculate query time
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    // Display results
+    printf("\n[Range Aggregate - %.1lf keys per range, mean value %.1lf] Insertion = %.2lf ms, Aggregate = %.2lf ms\n", read > 0 ? (double)covered / read : 0.0, covered > 0 ? (double)value_sum / covered : 0.0, w_time, r_time);
+}
+
+void Retention(const int write, const int read, SkipList<Key>& sl) {
+    // Append timestamps, dropping everything older than the window every interval
+    const int window = write / 10 + 1;
+    const int interval = write / 100 + 1;
+    double d_time = 0;
+    size_t deleted = 0;
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 1; i <= write; ++i) {
+        sl.Insert_usplit(i);
+        if (i % interval == 0 && i > window) {
+            auto d_start = Clock::now();
+            deleted += sl.DeleteRange(0, i - window);
+            auto d_end = Clock::now();
+            d_time += std::chrono::duration_cast<std::chrono::microseconds>(d_end - d_start).count() * 0.001;
+        }
+    }
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time, excluding the deletions
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001 - d_time;
+    results.Phase("delete_range", deleted, d_time * 0.001);
+
+    // Search random timestamps inside the window, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> r_keys = UniformKeys(gen, read, std::max(1, write - window + 1), std::max(1, write));
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (int i = 1; i <= read; ++i) {
+        sl.Contains(r_keys[i - 1]);
+    }
+    auto r_end = Clock::now();
+    perf.End("lookup", read);
 
     // Calculate search time
     float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
 
     // Display results
-    printf("\n[EvenSplit Zipfian] Insertion = %.2lf µs, Lookup = %.2lf µs\n", w_time, r_time);
+    printf("\n[Retention - %zu keys live] Insertion = %.2lf ms, DeleteRange = %.2lf ms, Search = %.2lf ms\n", sl.Size(), w_time, d_time, r_time);
+}
+
+void MemoryAccounting(const int write, const int read, SkipList<Key>& sl) {
+    // Uniformly distributed keys, generated before timing
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> w_keys = UniformKeys(gen, write, 2, write + 1);
+
+    // Insert random keys, polling the memory statistics like a metrics exporter
+    const int interval = 1000;
+    int polls = 0;
+    double p_time = 0;
+    perf.Begin();
+    auto w_start = Clock::now();
+    for (int i = 1; i <= write; ++i) {
+        sl.Insert_usplit(w_keys[i - 1]);
+        if (i % interval == 0) {
+            auto p_start = Clock::now();
+            sl.MemoryStats();
+            auto p_end = Clock::now();
+            p_time += std::chrono::duration_cast<std::chrono::microseconds>(p_end - p_start).count() * 0.001;
+            polls++;
+        }
+    }
+    auto w_end = Clock::now();
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    // Calculate insertion time, excluding the polls
+    float w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count() * 0.001 - p_time;
+    results.Phase("poll", polls, p_time * 0.001);
+
+    // Display the final statistics per level
+    auto usage = sl.MemoryStats();
+    for (int l = 0; l < usage.height; l++) {
+        printf("Level %d: %zu nodes, %zu bytes, %zu key bytes, fill", l, usage.nodes[l], usage.bytes[l], usage.key_bytes[l]);
+        for (int b = 0; b < FILL_BUCKETS; b++) {
+            printf(" %zu", usage.fill[l][b]);
+        }
+        printf("\n");
+    }
+
+    // Display results
+    printf("\n[Memory Accounting - %zu bytes, %d polls] Insertion = %.2lf ms, Poll = %.2lf ms\n", usage.total_bytes, polls, w_time, polls > 0 ? p_time / polls : 0.0);
+}
+
+// A YCSB operation mix: percent of op, the rest other, on Zipfian keys or on
+// keys skewed to the latest inserts
+struct Mix {
+    const char* name;
+    int percent;
+    WorkloadOp op;
+    WorkloadOp other;
+    bool latest;
+};
+
+// Mixes of YCSB A~F, run by benchmarks 4~9 and offered by 44~49
+static const Mix ycsb_mixes[] = {
+    {"YCSB-A", 50, kOpRead, kOpInsert, false},
+    {"YCSB-B", 95, kOpRead, kOpInsert, false},
+    {"YCSB-C", 100, kOpRead, kOpRead, false},
+    {"YCSB-D", 95, kOpRead, kOpInsert, true},
+    {"YCSB-E", 95, kOpScan, kOpInsert, false},
+    {"YCSB-F", 50, kOpRead, kOpReadModifyWrite, false},
+};
+
+inline void issueOp(SkipList<Key>& sl, uint8_t op, Key key, int scan_num = 100, Key end = Key()) {
+    switch (op) {
+        case kOpInsert: sl.Insert_usplit(key); break;
+        case kOpRead: sl.Contains(key); break;
+        case kOpScan: sl.Scan(key, scan_num); break;
+        case kOpReadModifyWrite: sl.Contains(key); sl.Insert_usplit(key); break;
+        case kOpDeleteRange: sl.DeleteRange(key, end); break;
+        case kOpDeleteFrom: sl.DeleteFrom(key); break;
+    }
+}
+
+// Per-thread part of the threaded sweeps: a private shard filled with the
+// write keys, then run through the read keys with their operations, every
+// operation timed on its own
+struct ShardRun {
+    std::vector<Key> w_keys;
+    std::vector<Key> r_keys;
+    std::vector<uint8_t> r_ops; // WorkloadOp of each read key
+    LatencyHistogram w_lat; // TSC ticks
+    LatencyHistogram r_lat;
+};
+
+void runShard(int id, std::atomic<int>* phase, std::atomic<int>* done, ShardRun* run) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(id % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+
+    SkipList<Key> sl;
+
+    while (phase->load(std::memory_order_acquire) < 1) std::this_thread::yield();
+    for (Key key : run->w_keys) {
+        uint64_t w_start = tsc.Start();
+        sl.Insert_usplit(key);
+        run->w_lat.RecordSpan(w_start, tsc.Stop());
+    }
+    done->fetch_add(1, std::memory_order_acq_rel);
+
+    while (phase->load(std::memory_order_acquire) < 2) std::this_thread::yield();
+    for (size_t i = 0; i < run->r_keys.size(); ++i) {
+        uint64_t r_start = tsc.Start();
+        issueOp(sl, run->r_ops[i], run->r_keys[i]);
+        run->r_lat.RecordSpan(r_start, tsc.Stop());
+    }
+    done->fetch_add(1, std::memory_order_acq_rel);
+}
+
+// Runs one thread per prepared shard, and reports aggregate throughput with the
+// latency percentiles of all threads' operations; r_phase names the read phase
+// as the single-threaded benchmark does
+void runShards(std::vector<ShardRun>& runs, const char* label, const char* r_phase = "lookup") {
+    int threads = runs.size();
+    std::vector<std::thread> workers;
+    std::atomic<int> phase(0), done(0);
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back(runShard, t, &phase, &done, &runs[t]);
+    }
+
+    auto w_start = Clock::now();
+    phase.store(1, std::memory_order_release);
+    while (done.load(std::memory_order_acquire) < threads) std::this_thread::yield();
+    auto w_end = Clock::now();
+
+    auto r_start = Clock::now();
+    phase.store(2, std::memory_order_release);
+    while (done.load(std::memory_order_acquire) < 2 * threads) std::this_thread::yield();
+    auto r_end = Clock::now();
+    for (auto& worker : workers) worker.join();
+
+    LatencyHistogram w_lat, r_lat;
+    for (auto& run : runs) {
+        w_lat.Merge(run.w_lat);
+        r_lat.Merge(run.r_lat);
+    }
+    double w_time = std::chrono::duration_cast<std::chrono::microseconds>(w_end - w_start).count();
+    double r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count();
+    std::string w_name = std::string(label) + " insert", r_name = std::string(label) + " " + r_phase;
+    results.Phase(w_name.c_str(), w_lat.Count(), w_time * 1e-6);
+    results.Phase(r_name.c_str(), r_lat.Count(), r_time * 1e-6);
+
+    auto printPercentiles = [](const std::string& phase, const LatencyHistogram& lat) {
+        if (lat.Count() == 0) return;
+        const double percentiles[] = {50, 99, 99.9};
+        double latency[3];
+        for (int i = 0; i < 3; i++) {
+            latency[i] = tsc.ToNs(lat.Percentile(percentiles[i]));
+            results.Percentile(phase.c_str(), percentiles[i], latency[i]);
+        }
+        printf(" (p50 = %.lf, p99 = %.lf, p99.9 = %.lf ns)", latency[0], latency[1], latency[2]);
+    };
+    std::string r_title = r_phase;
+    r_title[0] = std::toupper(r_title[0]);
+    printf("\n[%s] Insertion = %.2lf Mops/s", label, w_time > 0 ? w_lat.Count() / w_time : 0.0);
+    printPercentiles(w_name, w_lat);
+    printf(", %s = %.2lf Mops/s", r_title.c_str(), r_time > 0 ? r_lat.Count() / r_time : 0.0);
+    printPercentiles(r_name, r_lat);
+    printf("\n");
+}
+
+// Sweeps T from 1 to max_threads, splitting write and read evenly over T
+// threads that each own a shard, whose streams fill(t, shard_write,
+// shard_read, run) generates before timing
+template<typename Fill>
+void sweepThreads(const int write, const int read, int max_threads, const char* name, const char* r_phase, Fill fill) {
+    for (int threads = 1; threads <= max_threads; ++threads) {
+        std::vector<ShardRun> runs(threads);
+        for (int t = 0; t < threads; ++t) {
+            fill(t, write / threads, read / threads, runs[t]);
+        }
+
+        char label[96];
+        snprintf(label, sizeof(label), "%s - %d threads", name, threads);
+        runShards(runs, label, r_phase);
+    }
+}
+
+// Sweeps T from 1 to the core count over uniform or sequential keys looked up
+// in each thread's shard
+void Scalability(const int write, const int read, bool sequential, const char* name) {
+    int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::string sweep = std::string("Scalability ") + name;
+    sweepThreads(write, read, cores, sweep.c_str(), "lookup", [&](int t, int shard_write, int shard_read, ShardRun& run) {
+        if (sequential) {
+            for (int i = 1; i <= shard_write; ++i) run.w_keys.push_back(i);
+            for (int i = 1; i <= shard_read; ++i) run.r_keys.push_back((i - 1) % std::max(1, shard_write) + 1);
+        } else {
+            std::mt19937_64 gen(workload_seed + t);
+            run.w_keys = UniformKeys(gen, shard_write, 1, std::max(1, shard_write));
+            run.r_keys = UniformKeys(gen, shard_read, 1, std::max(1, shard_write));
+        }
+        run.r_ops.assign(run.r_keys.size(), kOpRead);
+    });
+}
+
+void ScalabilityUniform(const int write, const int read, SkipList<Key>& sl) {
+    Scalability(write, read, false, "Uniform");
+}
+
+void ScalabilitySequential(const int write, const int read, SkipList<Key>& sl) {
+    Scalability(write, read, true, "Sequential");
+}
+
+// Streams of synthetic benchmark 0~9 for one shard, drawn as the
+// single-threaded benchmark draws them
+void syntheticShard(int benchmark, std::mt19937_64& gen, const int write, const int read, ShardRun& run) {
+    switch (benchmark) {
+        case 0:
+            for (int i = 1; i <= write; ++i) run.w_keys.push_back(i);
+            for (int i = 1; i <= read; ++i) run.r_keys.push_back(i);
+            break;
+        case 1:
+            for (int i = write; i > 0; i--) run.w_keys.push_back(i);
+            for (int i = read; i > 0; i--) run.r_keys.push_back(i);
+            break;
+        case 2:
+            run.w_keys = UniformKeys(gen, write, 2, write + 1);
+            run.r_keys = UniformKeys(gen, read, 2, write + 1);
+            break;
+        case 3:
+            run.w_keys = ZipfianKeys(gen, write, write, write);
+            run.r_keys = ZipfianKeys(gen, read, write, read);
+            break;
+        default: {
+            const Mix& mix = ycsb_mixes[benchmark - 4];
+            run.w_keys = mix.latest ? LatestKeys(gen, write, write, write) : ZipfianKeys(gen, write, write, write);
+            run.r_keys = mix.latest ? LatestKeys(gen, read, write, read) : ZipfianKeys(gen, read, write, read);
+            run.r_ops = MixedOps(gen, read, mix.percent, mix.op, mix.other);
+            return;
+        }
+    }
+    run.r_ops.assign(run.r_keys.size(), kOpRead);
+}
+
+// Runs synthetic benchmark 0~9 on 1 to max_threads threads (DASL_THREADS),
+// each owning a shard with streams drawn by its own generator
+void ThreadSweep(int benchmark, const std::string& name, const int write, const int read, int max_threads) {
+    const char* r_phase = (benchmark == 8) ? "scan" : "lookup";
+    sweepThreads(write, read, max_threads, name.c_str(), r_phase, [&](int t, int shard_write, int shard_read, ShardRun& run) {
+        std::mt19937_64 gen(workload_seed + t);
+        syntheticShard(benchmark, gen, shard_write, shard_read, run);
+    });
+}
+
+// Sweeps theta from 0.5 to 1.2 on every core, each thread owning a shard with
+// scrambled Zipfian keys drawn by its own generator
+void SkewSweep(const int write, const int read, SkipList<Key>& sl) {
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int shard_write = write / threads, shard_read = read / threads;
+    for (int step = 5; step <= 12; ++step) {
+        double theta = step / 10.0;
+
+        // Generate the shards' streams in parallel, outside the timed region
+        std::vector<ShardRun> runs(threads);
+        std::vector<std::thread> generators;
+        for (int t = 0; t < threads; ++t) {
+            generators.emplace_back([&, t]() {
+                std::mt19937_64 gen(workload_seed + t);
+                runs[t].w_keys = ScrambledZipfianKeys(gen, shard_write, std::max(1, shard_write), theta);
+                runs[t].r_keys = ScrambledZipfianKeys(gen, shard_read, std::max(1, shard_write), theta);
+                runs[t].r_ops.assign(shard_read, kOpRead);
+            });
+        }
+        for (auto& generator : generators) generator.join();
+
+        char label[64];
+        snprintf(label, sizeof(label), "Skew Sweep theta = %.1lf - %d threads", theta, threads);
+        runShards(runs, label);
+    }
+}
+
+// Offered loads of the sweep as fractions of the closed-loop capacity; past 1
+// the queue grows for the whole run
+static const double open_loop_loads[] = {0.1, 0.25, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, 1.1};
+
+// Loads write keys, measures the mix's closed-loop capacity, then offers read
+// operations of the mix at each rate of the sweep (or at DASL_RATE). Every
+// operation is issued when it is due, or at once when the index is behind,
+// and its latency counts from when it was due, so time spent queued behind
+// slower operations is included instead of omitted.
+void OpenLoop(const Mix& mix, const int write, const int read, SkipList<Key>& sl) {
+    std::mt19937_64 gen(workload_seed);
+    ArrivalProcess arrival = WorkloadArrival();
+    auto mixKeys = [&](size_t n) { return mix.latest ? LatestKeys(gen, n, write, read) : ZipfianKeys(gen, n, write, read); };
+    std::vector<Key> w_keys = mix.latest ? LatestKeys(gen, write, write, write) : ZipfianKeys(gen, write, write, write);
+
+    perf.Begin();
+    for (int i = 0; i < write; ++i) sl.Insert_usplit(w_keys[i]);
+    perf.End("insert", write);
+    std::cout << "After Insert\n";
+
+    std::vector<Key> r_keys = mixKeys(read);
+    std::vector<uint8_t> r_ops = MixedOps(gen, read, mix.percent, mix.op, mix.other);
+    perf.Begin();
+    auto c_start = Clock::now();
+    for (int i = 0; i < read; ++i) issueOp(sl, r_ops[i], r_keys[i]);
+    auto c_end = Clock::now();
+    perf.End("closed-loop", read);
+    double capacity = read / std::max(1e-9, std::chrono::duration<double>(c_end - c_start).count());
+    printf("\n[Open-Loop %s] Capacity (closed loop) = %.0lf ops/s, %s arrivals\n", mix.name, capacity, arrival == kArrivalPoisson ? "Poisson" : "constant");
+
+    std::vector<double> rates;
+    if (WorkloadRate() > 0) rates.push_back(WorkloadRate());
+    else for (double load : open_loop_loads) rates.push_back(load * capacity);
+
+    for (double rate : rates) {
+        // Fresh operations and their due times in TSC ticks, before timing
+        r_keys = mixKeys(read);
+        r_ops = MixedOps(gen, read, mix.percent, mix.op, mix.other);
+        std::vector<uint64_t> due = ArrivalTimes(gen, read, rate, arrival);
+        for (uint64_t& t : due) t = (uint64_t)(t * tsc.TicksPerNs());
+
+        LatencyHistogram latency, service; // From due and from issue, in TSC ticks
+        char phase[64];
+        snprintf(phase, sizeof(phase), "open-loop %.0lf", rate);
+        perf.Begin();
+        uint64_t start = tsc.Start();
+        for (int i = 0; i < read; ++i) {
+            uint64_t due_at = start + due[i];
+            uint64_t now = tsc.Start();
+            while (now < due_at) {
+                _mm_pause();
+                now = tsc.Start();
+            }
+            issueOp(sl, r_ops[i], r_keys[i]);
+            uint64_t end = tsc.Stop();
+            latency.RecordSpan(due_at, end);
+            service.RecordSpan(now, end);
+        }
+        uint64_t elapsed = tsc.ToNs(tsc.Elapsed(start, tsc.Stop()));
+        perf.End(phase, read);
+
+        const double percentiles[] = {50, 99, 99.9, 99.99};
+        printf("\n[Open-Loop %s] Offered = %.0lf ops/s, Achieved = %.0lf ops/s, Latency", mix.name, rate, elapsed > 0 ? read * 1e9 / elapsed : 0.0);
+        for (double p : percentiles) {
+            double ns = tsc.ToNs(latency.Percentile(p));
+            printf(" p%g = %.lf", p, ns);
+            results.Percentile(phase, p, ns);
+        }
+        printf(" ns, Service p50 = %lu, p99 = %lu ns\n", tsc.ToNs(service.Percentile(50)), tsc.ToNs(service.Percentile(99)));
+    }
+}
+
+void OpenLoopA(const int write, const int read, SkipList<Key>& sl) {
+    OpenLoop(ycsb_mixes[0], write, read, sl);
+}
+
+void OpenLoopB(const int write, const int read, SkipList<Key>& sl) {
+    OpenLoop(ycsb_mixes[1], write, read, sl);
+}
+
+void OpenLoopC(const int write, const int read, SkipList<Key>& sl) {
+    OpenLoop(ycsb_mixes[2], write, read, sl);
+}
+
+void OpenLoopD(const int write, const int read, SkipList<Key>& sl) {
+    OpenLoop(ycsb_mixes[3], write, read, sl);
+}
+
+void OpenLoopE(const int write, const int read, SkipList<Key>& sl) {
+    OpenLoop(ycsb_mixes[4], write, read, sl);
+}
+
+void OpenLoopF(const int write, const int read, SkipList<Key>& sl) {
+    OpenLoop(ycsb_mixes[5], write, read, sl);
+}
+
+// Streams the operations of the trace named by DASL_TRACE through the index,
+// timing each. Write and Read Count are not used; the trace is mapped and
+// faulted in before timing.
+void Replay(const int write, const int read, SkipList<Key>& sl) {
+    const char* env = std::getenv("DASL_TRACE");
+    std::string path = (env != nullptr) ? env : TRACE_FILE;
+    Trace trace;
+    if (!trace.Load(path)) {
+        std::cerr << "Failed to load trace: " << path << std::endl;
+        return;
+    }
+    const TraceRecord* records = trace.data();
+    size_t n = trace.size();
+
+    LatencyHistogram all, by_op[kOpDeleteFrom + 1]; // TSC ticks
+    perf.Begin();
+    auto r_start = Clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        const TraceRecord& record = records[i];
+        uint64_t start = tsc.Start();
+        issueOp(sl, record.op, record.key, record.arg, record.end);
+        uint64_t stop = tsc.Stop();
+        all.RecordSpan(start, stop);
+        if (record.op <= kOpDeleteFrom) by_op[record.op].RecordSpan(start, stop);
+    }
+    auto r_end = Clock::now();
+    perf.End("replay", n);
+    float r_time = std::chrono::duration_cast<std::chrono::microseconds>(r_end - r_start).count() * 0.001;
+
+    const double percentiles[] = {50, 99, 99.9, 99.99};
+    printf("\n[Trace Replay] %zu operations = %.2lf ms, Latency", n, r_time);
+    for (double p : percentiles) {
+        double ns = tsc.ToNs(all.Percentile(p));
+        printf(" p%g = %.lf", p, ns);
+        results.Percentile("replay", p, ns);
+    }
+    printf(" ns");
+    if (all.Dropped() > 0) printf(", %lu untimed (counter ran backwards)", all.Dropped());
+    printf("\n");
+    const char* names[] = {"insert", "lookup", "scan", "read-modify-write", "delete-range", "delete-from"};
+    for (int op = kOpInsert; op <= kOpDeleteFrom; op++) {
+        if (by_op[op].Count() == 0) continue;
+        printf("%s: %lu ops, p50 = %lu, p99 = %lu, p99.9 = %lu ns\n", names[op], by_op[op].Count(), tsc.ToNs(by_op[op].Percentile(50)), tsc.ToNs(by_op[op].Percentile(99)), tsc.ToNs(by_op[op].Percentile(99.9)));
+    }
+}
+
+// Compares a list filled through path and Insert_lazy in turn with a std::set
+// of the same keys: membership through both lookup paths, and the leaf order
+// through a full scan. Returns the mismatches found.
+size_t checkLazyMix(const char* name, void (SkipList<Key>::*path)(const Key&), const std::vector<Key>& keys) {
+    SkipList<Key> sl;
+    std::set<Key> reference;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (i % 2 == 0) (sl.*path)(keys[i]);
+        else sl.Insert_lazy(keys[i]);
+        reference.insert(keys[i]);
+    }
+
+    size_t mismatches = 0;
+    for (Key key : reference) {
+        if (!sl.Contains(key)) mismatches++;
+        if (!sl.Contains_Raise(key)) mismatches++;
+    }
+    std::vector<Key> scanned(reference.size() + 1);
+    size_t n = sl.Scan(Key(), scanned.size(), scanned.data());
+    if (n != reference.size() || !std::equal(reference.begin(), reference.end(), scanned.begin())) mismatches++;
+
+    printf("[Consistency] %s + lazy: %zu keys, %zu mismatches\n", name, reference.size(), mismatches);
+    return mismatches;
+}
+
+// Compares a list filled through path, with every fourth key Put with a value
+// instead if put is set, with a std::map of the same keys: values through Get,
+// and the subtree counts and summaries through the order statistics. Every
+// order statistic is checked at the keys themselves and at probes between them.
+// Returns the mismatches found.
+size_t checkStatistics(const char* name, void (SkipList<Key>::*path)(const Key&), const std::vector<Key>& keys, bool put) {
+    SkipList<Key> sl;
+    std::map<Key, Value> reference;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (put && i % 4 == 0) {
+            sl.Put(keys[i], keys[i] % 1000 + 1);
+            reference[keys[i]] = keys[i] % 1000 + 1;
+        } else {
+            (sl.*path)(keys[i]);
+            reference.emplace(keys[i], Value());
+        }
+    }
+
+    size_t mismatches = 0;
+    if (sl.Size() != reference.size()) mismatches++;
+    size_t rank = 0;
+    for (const auto& entry : reference) {
+        Value value;
+        if (put && (!sl.Get(entry.first, &value) || value != entry.second)) mismatches++;
+        if (rank % 97 == 0) {
+            if (sl.Rank(entry.first) != rank || sl.Rank(entry.first + 1) != rank + 1) mismatches++;
+            if (sl.Select(rank) != entry.first) mismatches++;
+        }
+        rank++;
+    }
+
+    std::mt19937_64 gen(workload_seed);
+    std::uniform_int_distribution<Key> probe(0, reference.empty() ? 0 : reference.rbegin()->first + 1);
+    for (int i = 0; i < 200; i++) {
+        Key lo = probe(gen), hi = probe(gen);
+        if (hi < lo) std::swap(lo, hi);
+        SkipList<Key>::Summary expected = {0, Value(), std::numeric_limits<Value>::max(), Value()};
+        for (auto it = reference.lower_bound(lo); it != reference.end() && it->first < hi; ++it) {
+            expected.count++;
+            expected.sum += it->second;
+            expected.min = std::min(expected.min, it->second);
+            expected.max = std::max(expected.max, it->second);
+        }
+        if (expected.count == 0) expected.min = Value();
+        SkipList<Key>::Summary summary = sl.Aggregate(lo, hi);
+        if (sl.CountRange(lo, hi) != expected.count || summary.count != expected.count || summary.sum != expected.sum ||
+            summary.min != expected.min || summary.max != expected.max) mismatches++;
+    }
+
+    printf("[Consistency] %s%s: %zu keys, %zu mismatches\n", name, put ? " + Put" : "", reference.size(), mismatches);
+    return mismatches;
+}
+
+// Runs every insert path DASL can mix on one list against a reference, and
+// fails the run on any mismatch. Insert_Array builds upper levels of its own
+// and is not mixed with the other paths, nor given values.
+void Consistency(const int write, const int read, SkipList<Key>& sl) {
+    std::mt19937_64 gen(workload_seed);
+    std::vector<Key> keys = UniformKeys(gen, write, 1, 4 * (Key)std::max(write, 1));
+
+    size_t mismatches = 0;
+    mismatches += checkLazyMix("usplit", &SkipList<Key>::Insert_usplit, keys);
+    mismatches += checkLazyMix("asplit", &SkipList<Key>::Insert_asplit, keys);
+    mismatches += checkLazyMix("esplit", &SkipList<Key>::Insert_esplit, keys);
+    mismatches += checkLazyMix("+Search", &SkipList<Key>::Insert_Search, keys);
+    mismatches += checkLazyMix("+Raise", &SkipList<Key>::Insert_Raise, keys);
+    mismatches += checkLazyMix("future", &SkipList<Key>::Insert_future, keys);
+    mismatches += checkStatistics("usplit", &SkipList<Key>::Insert_usplit, keys, true);
+    mismatches += checkStatistics("esplit", &SkipList<Key>::Insert_esplit, keys, true);
+    mismatches += checkStatistics("+Search", &SkipList<Key>::Insert_Search, keys, true);
+    mismatches += checkStatistics("+Raise", &SkipList<Key>::Insert_Raise, keys, true);
+    mismatches += checkStatistics("future", &SkipList<Key>::Insert_future, keys, true);
+    mismatches += checkStatistics("+Array", &SkipList<Key>::Insert_Array, keys, false);
+
+    check_failures += mismatches;
+    printf("\n[Consistency] %s\n", mismatches == 0 ? "passed" : "FAILED");
+}
+
+// Benchmarks whose operations all reach the SkipList of main through recorded
+// entry points. The others issue them against their own or sharded lists (31,
+// 37~39, 51, and 0~9 swept over threads), against a baseline index, or as snapshot
+// scans and order statistic queries that no trace operation stands for (32~34).
+bool recordable(int benchmark, const std::string& index, int threads) {
+    if (index != "dasl" || threads > 0) return false;
+    switch (benchmark) {
+        case 31: case 32: case 33: case 34: case 37: case 38: case 39: case 51: return false;
+        default: return true;
+    }
+}
+
+// Counters of the calling thread, printed when built with make STATS=1
+void printStats(const OpStats& stats) {
+    printf("\n[Operation Stats] inserts = %lu, lookups = %lu, scans = %lu\n", stats.inserts, stats.lookups, stats.scans);
+    printf("levels = %lu, nodes = %lu, linear searches = %lu, binary searches = %lu\n", stats.levels, stats.nodes, stats.linear_searches, stats.binary_searches);
+    printf("memmove bytes = %lu, shifts = %lu, splits = %lu, propagations = %lu\n", stats.memmove_bytes, stats.shifts, stats.splits, stats.propagations);
+
+    auto printHistogram = [](const char* name, const uint64_t* hist) {
+        printf("%s:", name);
+        for (int b = 0; b < STAT_BUCKETS; b++) {
+            if (hist[b] == 0) continue;
+            if (b == 0) printf(" [0] %lu", hist[b]);
+            else printf(" [%lu, %lu) %lu", 1UL << (b - 1), (b == 64) ? ~0UL : 1UL << b, hist[b]);
+        }
+        printf("\n");
+    };
+    printHistogram("nodes per operation", stats.nodes_hist);
+    printHistogram("memmove bytes per insert", stats.memmove_hist);
+    printHistogram("propagations per insert", stats.propagation_hist);
 }
 
 void printUsage(const char* programName) {
-    std::cerr << "\nUsage: " << programName << " [Write Count] [Read Count] [Benchmark]\n\n"
+    std::cerr << "\nUsage: " << programName << " [Write Count] [Read Count] [Benchmark] [Index]\n\n"
               << "Benchmark can be selected by number or name.\n\n"
               << "Synthetic Benchmarks:\n"
               << " 0 - Sequential\n"
@@ -958,7 +1989,8 @@ void printUsage(const char* programName) {
               << " 10 - fb\n"
               << " 11 - books\n"
               << " 12 - wiki\n"
-              << " 13 - osm\n\n"
+              << " 13 - osm\n"
+              << " 40~43 - Offline stand-ins for fb, books, wiki, osm (Write Count keys)\n\n"
               << "Latency Benchmarks:\n"
               << " 14 - Sequential_latency\n"
               << " 15 - Uniform_latency\n"
@@ -974,11 +2006,44 @@ void printUsage(const char* programName) {
               << " 22 - Sequential\n"
               << " 23 - Rev-Sequential\n"
               << " 24 - Uniform\n"
-              << " 25 - Zipfian\n";
+              << " 25 - Zipfian\n\n"
+              << "Adaptive Split Benchmarks:\n"
+              << " 26 - Mixed (Sequential bursts + Uniform)\n\n"
+              << "Lazy Insertion Benchmarks:\n"
+              << " 27 - Uniform_latency (deferred upper levels)\n\n"
+              << "Maintenance Benchmarks:\n"
+              << " 28 - Compaction (Uniform)\n\n"
+              << "Batch Insertion Benchmarks:\n"
+              << " 29 - Uniform (4096-key batches)\n"
+              << " 30 - Parallel bulk load (Uniform, all cores)\n\n"
+              << "Sharded Benchmarks:\n"
+              << " 31 - Uniform (one shard per core)\n\n"
+              << "Snapshot Benchmarks:\n"
+              << " 32 - Uniform inserts with chunked scans of a live snapshot\n\n"
+              << "Order Statistic Benchmarks:\n"
+              << " 33 - Rank and Select (Uniform)\n"
+              << " 34 - Range aggregates over 10% of the key space (Uniform)\n\n"
+              << "Range Deletion Benchmarks:\n"
+              << " 35 - Retention of the newest 10% of sequential keys\n\n"
+              << "Memory Accounting Benchmarks:\n"
+              << " 36 - Memory statistics polled every 1000 uniform inserts\n\n"
+              << "Scalability Benchmarks:\n"
+              << " 37 - Uniform on 1 to core count threads, one private shard each\n"
+              << " 38 - Sequential on 1 to core count threads, one private shard each\n"
+              << " 39 - Scrambled Zipfian with theta 0.5 to 1.2 on all cores, one private shard each\n"
+              << " 0~9 - Swept over 1 to DASL_THREADS threads, one private shard each\n\n"
+              << "Open-Loop Benchmarks:\n"
+              << " 44~49 - YCSB(A~F) offered at 10% to 110% of capacity (DASL_RATE, DASL_ARRIVAL)\n\n"
+              << "Trace Benchmarks:\n"
+              << " 50 - Replay of the trace named by DASL_TRACE (any run records one with DASL_RECORD)\n\n"
+              << "Consistency Checks:\n"
+              << " 51 - Each insert path mixed with lazy insertion or Put, checked against std::set and std::map (Write Count keys)\n\n"
+              << "Index (benchmarks 0~25 only, default dasl):\n"
+              << " dasl, set (std::set), vector (sorted vector), btree (B+-tree), skiplist (LevelDB-style), all (each in turn)\n";
 }
 
 int main(int argc, char *argv[]) {
-    if (argc != 4) {
+    if (argc != 4 && argc != 5) {
         printUsage(argv[0]);
         return 1;
     }
@@ -986,49 +2051,150 @@ int main(int argc, char *argv[]) {
     const int W = std::atoi(argv[1]);  // Insertion count
     const int R = std::atoi(argv[2]);  // Lookup count
     const int B = std::atoi(argv[3]);  // Benchmark type
+    const std::string I = (argc == 5) ? argv[4] : "dasl";  // Index of benchmarks 0~25
+    if (I != "dasl" && I != "set" && I != "vector" && I != "btree" && I != "skiplist" && I != "all") {
+        std::cerr << "Invalid index option provided.\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (I != "dasl" && (B < 0 || B > 25)) {
+        std::cerr << "Benchmark " << B << " runs on DASL only.\n";
+        return 1;
+    }
+    const int T = WorkloadThreads();  // Threads benchmarks 0~9 are swept over
+    if (T < 0 || (T > 0 && (I != "dasl" || B < 0 || B > 9))) {
+        std::cerr << "DASL_THREADS sweeps benchmarks 0~9 on dasl only, over 1 to a positive thread count.\n";
+        return 1;
+    }
 
+    std::srand(workload_seed); // Level choices of the randomized insert paths
+    perf.SetSink(&comparison);
     SkipList<Key> sl;
 
+    // DASL_RECORD names a trace file capturing every operation issued against sl
+    const char* record_path = std::getenv("DASL_RECORD");
+    TraceWriter trace_writer;
+    TraceRecorder recorder(&trace_writer);
+    if (record_path != nullptr) {
+        if (!recordable(B, I, T)) {
+            std::cerr << "Benchmark " << B << " on " << I << " issues operations a trace cannot capture, unset DASL_RECORD.\n";
+            return 1;
+        }
+        if (!trace_writer.Open(record_path)) {
+            std::cerr << "Failed to open trace: " << record_path << std::endl;
+            return 1;
+        }
+        sl.SetRecorder(&recorder);
+    }
+
+    bool written = true; // Results of every run written so far
+    auto writeResults = [&](auto& index) {
+        if (!results.Enabled()) return;
+        recordIndex(index);
+        written = results.Write() && written;
+    };
+
     auto runBenchmarkType1 = [&](const std::string& name, void (*benchmarkFunc)(int, int, SkipList<Key>&)) {
-        std::cout << "\n[" << name << " Benchmark in progress...]\n\n";
+        std::cout << "\n[" << name << " Benchmark in progress, seed " << workload_seed << "...]\n\n";
+        results.SetRun(name, "DASL", B, W, R, workload_seed);
         benchmarkFunc(W, R, sl);
+        writeResults(sl);
     };
 
-    auto runBenchmarkType2 = [&](const std::string& name, void (*benchmarkFunc)(SkipList<Key>&)) {
-        std::cout << "\n[" << name << " Benchmark in progress...]\n\n";
-        benchmarkFunc(sl);
+    // Benchmarks 0~25 run on the chosen index, each in a fresh instance, and
+    // with "all" on DASL and every baseline followed by a side-by-side table.
+    // With DASL_THREADS, 0~9 are swept over threads owning a shard each instead.
+    auto runComparable = [&](const std::string& name, auto benchmarkFunc) {
+        if (T > 0) {
+            std::cout << "\n[" << name << " Benchmark on 1 to " << T << " threads in progress, seed " << workload_seed << "...]\n\n";
+            results.SetRun(name, "DASL", B, W, R, workload_seed);
+            ThreadSweep(B, name, W, R, T);
+            writeResults(sl);
+            return;
+        }
+        auto runOn = [&](const char* structure, auto& index) {
+            std::cout << "\n[" << name << " Benchmark on " << structure << " in progress, seed " << workload_seed << "...]\n\n";
+            results.SetRun(name, structure, B, W, R, workload_seed);
+            comparison.Begin(structure);
+            benchmarkFunc(W, R, index);
+            writeResults(index);
+        };
+        if (I == "dasl" || I == "all") runOn("DASL", sl);
+        if (I == "set" || I == "all") {
+            StdSetIndex<Key> index;
+            runOn(index.Name(), index);
+        }
+        if (I == "vector" || I == "all") {
+            SortedVectorIndex<Key> index;
+            runOn(index.Name(), index);
+        }
+        if (I == "btree" || I == "all") {
+            BPlusTreeIndex<Key> index;
+            runOn(index.Name(), index);
+        }
+        if (I == "skiplist" || I == "all") {
+            ClassicSkipList<Key> index;
+            runOn(index.Name(), index);
+        }
+        if (I == "all") comparison.Print(name);
     };
 
     switch (B) {
         // Type 1:
-        case 0: runBenchmarkType1("Sequential", Sequential); break;
-        case 1: runBenchmarkType1("Rev-Sequential", RevSequential); break;
-        case 2: runBenchmarkType1("Uniform", Uniform); break;
-        case 3: runBenchmarkType1("Zipfian", Zipfian); break;
-        case 4: runBenchmarkType1("YCSB-A", YCSBWorkloadA); break;
-        case 5: runBenchmarkType1("YCSB-B", YCSBWorkloadB); break;
-        case 6: runBenchmarkType1("YCSB-C", YCSBWorkloadC); break;
-        case 7: runBenchmarkType1("YCSB-D", YCSBWorkloadD); break;
-        case 8: runBenchmarkType1("YCSB-E", YCSBWorkloadE); break;
-        case 9: runBenchmarkType1("YCSB-F", YCSBWorkloadF); break;
-        case 14: runBenchmarkType1("Sequential Latency", Sequential_latency); break;
-        case 15: runBenchmarkType1("Uniform Latency", Uniform_latency); break;
-        case 16: runBenchmarkType1("Zipfian Latency", Zipfian_latency); break;
-        case 17: runBenchmarkType1("Uniform Scan", Uniform_Scan); break;
-        case 18: runBenchmarkType1("+Array", Array); break;
-        case 19: runBenchmarkType1("+Raise", Raise); break;
-        case 20: runBenchmarkType1("+Search", Search); break;
-        case 21: runBenchmarkType1("+Split", Split); break;
-        case 22: runBenchmarkType1("EvenSplit-Sequential", EvenSplitSequential); break;
-        case 23: runBenchmarkType1("EvenSplit-RevSequential", EvenSplitRevSequential); break;
-        case 24: runBenchmarkType1("EvenSplit-Uniform", EvenSplitUniform); break;
-        case 25: runBenchmarkType1("EvenSplit-Zipfian", EvenSplitZipfian); break;
+        case 0: runComparable("Sequential", [](int write, int read, auto& index) { Sequential(write, read, index); }); break;
+        case 1: runComparable("Rev-Sequential", [](int write, int read, auto& index) { RevSequential(write, read, index); }); break;
+        case 2: runComparable("Uniform", [](int write, int read, auto& index) { Uniform(write, read, index); }); break;
+        case 3: runComparable("Zipfian", [](int write, int read, auto& index) { Zipfian(write, read, index); }); break;
+        case 4: runComparable("YCSB-A", [](int write, int read, auto& index) { YCSBWorkloadA(write, read, index); }); break;
+        case 5: runComparable("YCSB-B", [](int write, int read, auto& index) { YCSBWorkloadB(write, read, index); }); break;
+        case 6: runComparable("YCSB-C", [](int write, int read, auto& index) { YCSBWorkloadC(write, read, index); }); break;
+        case 7: runComparable("YCSB-D", [](int write, int read, auto& index) { YCSBWorkloadD(write, read, index); }); break;
+        case 8: runComparable("YCSB-E", [](int write, int read, auto& index) { YCSBWorkloadE(write, read, index); }); break;
+        case 9: runComparable("YCSB-F", [](int write, int read, auto& index) { YCSBWorkloadF(write, read, index); }); break;
+        case 14: runComparable("Sequential Latency", [](int write, int read, auto& index) { Sequential_latency(write, read, index); }); break;
+        case 15: runComparable("Uniform Latency", [](int write, int read, auto& index) { Uniform_latency(write, read, index); }); break;
+        case 16: runComparable("Zipfian Latency", [](int write, int read, auto& index) { Zipfian_latency(write, read, index); }); break;
+        case 17: runComparable("Uniform Scan", [](int write, int read, auto& index) { Uniform_Scan(write, read, index); }); break;
+        case 18: runComparable("+Array", [](int write, int read, auto& index) { Array(write, read, index); }); break;
+        case 19: runComparable("+Raise", [](int write, int read, auto& index) { Raise(write, read, index); }); break;
+        case 20: runComparable("+Search", [](int write, int read, auto& index) { Search(write, read, index); }); break;
+        case 21: runComparable("+Split", [](int write, int read, auto& index) { Split(write, read, index); }); break;
+        case 22: runComparable("EvenSplit-Sequential", [](int write, int read, auto& index) { EvenSplitSequential(write, read, index); }); break;
+        case 23: runComparable("EvenSplit-RevSequential", [](int write, int read, auto& index) { EvenSplitRevSequential(write, read, index); }); break;
+        case 24: runComparable("EvenSplit-Uniform", [](int write, int read, auto& index) { EvenSplitUniform(write, read, index); }); break;
+        case 25: runComparable("EvenSplit-Zipfian", [](int write, int read, auto& index) { EvenSplitZipfian(write, read, index); }); break;
+        case 26: runBenchmarkType1("AdaptiveSplit-Mixed", AdaptiveSplitMixed); break;
+        case 27: runBenchmarkType1("Lazy Latency", Lazy_latency); break;
+        case 28: runBenchmarkType1("Compaction", Compaction); break;
+        case 29: runBenchmarkType1("Batch-Uniform", BatchUniform); break;
+        case 30: runBenchmarkType1("Bulk-Load", BulkLoad); break;
+        case 31: runBenchmarkType1("Sharded-Uniform", ShardedUniform); break;
+        case 32: runBenchmarkType1("Snapshot-Scan", SnapshotScan); break;
+        case 33: runBenchmarkType1("Order-Statistics", OrderStatistics); break;
+        case 34: runBenchmarkType1("Range-Aggregate", RangeAggregate); break;
+        case 35: runBenchmarkType1("Retention", Retention); break;
+        case 36: runBenchmarkType1("Memory-Accounting", MemoryAccounting); break;
+        case 37: runBenchmarkType1("Scalability-Uniform", ScalabilityUniform); break;
+        case 38: runBenchmarkType1("Scalability-Sequential", ScalabilitySequential); break;
+        case 39: runBenchmarkType1("Skew-Sweep", SkewSweep); break;
+        case 40: runBenchmarkType1("Synthetic Dataset (fb)", SyntheticFb); break;
+        case 41: runBenchmarkType1("Synthetic Dataset (books)", SyntheticBooks); break;
+        case 42: runBenchmarkType1("Synthetic Dataset (wiki)", SyntheticWiki); break;
+        case 43: runBenchmarkType1("Synthetic Dataset (osm)", SyntheticOsm); break;
+        case 44: runBenchmarkType1("Open-Loop YCSB-A", OpenLoopA); break;
+        case 45: runBenchmarkType1("Open-Loop YCSB-B", OpenLoopB); break;
+        case 46: runBenchmarkType1("Open-Loop YCSB-C", OpenLoopC); break;
+        case 47: runBenchmarkType1("Open-Loop YCSB-D", OpenLoopD); break;
+        case 48: runBenchmarkType1("Open-Loop YCSB-E", OpenLoopE); break;
+        case 49: runBenchmarkType1("Open-Loop YCSB-F", OpenLoopF); break;
+        case 50: runBenchmarkType1("Trace Replay", Replay); break;
+        case 51: runBenchmarkType1("Consistency", Consistency); break;
         
         // Type 2:
-        case 10: runBenchmarkType2("Real-World Dataset (fb)", fb); break;
-        case 11: runBenchmarkType2("Real-World Dataset (books)", books); break;
-        case 12: runBenchmarkType2("Real-World Dataset (wiki)", wiki); break;
-        case 13: runBenchmarkType2("Real-World Dataset (osm)", osm); break;
+        case 10: runComparable("Real-World Dataset (fb)", [](int, int, auto& index) { fb(index); }); break;
+        case 11: runComparable("Real-World Dataset (books)", [](int, int, auto& index) { books(index); }); break;
+        case 12: runComparable("Real-World Dataset (wiki)", [](int, int, auto& index) { wiki(index); }); break;
+        case 13: runComparable("Real-World Dataset (osm)", [](int, int, auto& index) { osm(index); }); break;
 
         default:
             std::cerr << "Invalid benchmark option provided.\n";
@@ -1036,5 +2202,19 @@ int main(int argc, char *argv[]) {
             return 1;
     }
 
-    return 0;
+#ifdef DASL_STATS
+    printStats(StatsSnapshot());
+#endif
+
+    if (record_path != nullptr) {
+        sl.SetRecorder(nullptr);
+        uint64_t recorded = trace_writer.Count();
+        if (!trace_writer.Close()) {
+            std::cerr << "Failed to write trace: " << record_path << std::endl;
+            return 1;
+        }
+        printf("\n[Trace] %lu operations recorded to %s\n", (unsigned long)recorded, record_path);
+    }
+
+    return (written && check_failures == 0) ? 0 : 1;
 }
\ No newline at end of file
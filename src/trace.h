@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "skiplist.h"
+#include "workload.h"
+
+#define TRACE_MAGIC 0x3230435254534144ULL // "DASTRC02" read as a little-endian uint64
+#define TRACE_FILE "trace.bin" // Replayed when DASL_TRACE is not set
+#define TRACE_BUFFER (1 << 20) // Bytes buffered by TraceWriter between writes
+
+// Operation trace file: a TraceHeader followed by count 24-byte records, so
+// the records can be mapped and indexed in place. op is a WorkloadOp; end is
+// the exclusive upper key of kOpDeleteRange and 0 otherwise (kOpDeleteFrom
+// drops every key from key on, the largest Key included); arg is the scan
+// length of kOpScan and the value size of the other operations (0 when
+// unknown). Values themselves are not recorded, so value sizes are carried,
+// not used.
+struct TraceHeader {
+    uint64_t magic;
+    uint64_t count;
+};
+
+struct TraceRecord {
+    Key key;
+    Key end;
+    uint32_t arg;
+    uint8_t op;
+    uint8_t reserved[3];
+};
+static_assert(sizeof(TraceRecord) == 24, "trace records are 24 bytes");
+
+// Appends records to a trace file; the count in the header is filled in by Close
+class TraceWriter {
+   public:
+    TraceWriter() : file_(nullptr), count_(0) {}
+    ~TraceWriter() { Close(); }
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    bool Open(const std::string& path);
+    inline void Append(uint8_t op, const Key& key, uint32_t arg, const Key& end = Key()) {
+        TraceRecord record = {key, end, arg, op, {0, 0, 0}};
+        fwrite(&record, sizeof(record), 1, file_);
+        count_++;
+    }
+    bool Close();
+
+    inline uint64_t Count() const { return count_; }
+
+   private:
+    FILE* file_;
+    uint64_t count_;
+};
+
+inline bool TraceWriter::Open(const std::string& path) {
+    Close();
+    file_ = fopen(path.c_str(), "wb");
+    if (file_ == nullptr) return false;
+    setvbuf(file_, nullptr, _IOFBF, TRACE_BUFFER);
+    count_ = 0;
+    TraceHeader header = {TRACE_MAGIC, 0};
+    return fwrite(&header, sizeof(header), 1, file_) == 1;
+}
+
+inline bool TraceWriter::Close() {
+    if (file_ == nullptr) return true;
+    TraceHeader header = {TRACE_MAGIC, count_};
+    bool ok = fseek(file_, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, file_) == 1;
+    ok = (fclose(file_) == 0) && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+// Writes the operations issued against the SkipList it is set on to a trace
+class TraceRecorder : public OpRecorder<Key> {
+   public:
+    explicit TraceRecorder(TraceWriter* writer) : writer_(writer) {}
+
+    void OnInsert(const Key& key) override { writer_->Append(kOpInsert, key, 0); }
+    void OnLookup(const Key& key) override { writer_->Append(kOpRead, key, 0); }
+    void OnScan(const Key& key, size_t scan_num) override { writer_->Append(kOpScan, key, scan_num); }
+    void OnDeleteRange(const Key& lo, const Key& hi) override { writer_->Append(kOpDeleteRange, lo, 0, hi); }
+    void OnDeleteFrom(const Key& lo) override { writer_->Append(kOpDeleteFrom, lo, 0); }
+
+   private:
+    TraceWriter* writer_;
+};
+
+// Records of a trace file, mapped read-only and faulted in by Load, so a
+// replay reads memory rather than the disk
+class Trace {
+   public:
+    Trace() : map_(MAP_FAILED), map_bytes_(0), records_(nullptr), size_(0) {}
+    ~Trace();
+    Trace(const Trace&) = delete;
+    Trace& operator=(const Trace&) = delete;
+
+    bool Load(const std::string& path);
+
+    inline const TraceRecord* data() const { return records_; }
+    inline size_t size() const { return size_; }
+
+   private:
+    void* map_;
+    size_t map_bytes_;
+    const TraceRecord* records_;
+    size_t size_;
+};
+
+inline Trace::~Trace() {
+    if (map_ != MAP_FAILED) munmap(map_, map_bytes_);
+}
+
+inline bool Trace::Load(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TraceHeader)) {
+        close(fd);
+        return false;
+    }
+    map_bytes_ = st.st_size;
+    map_ = mmap(nullptr, map_bytes_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (map_ == MAP_FAILED) return false;
+    madvise(map_, map_bytes_, MADV_WILLNEED);
+
+    const TraceHeader* header = static_cast<const TraceHeader*>(map_);
+    if (header->magic != TRACE_MAGIC || header->count > (map_bytes_ - sizeof(TraceHeader)) / sizeof(TraceRecord)) {
+        return false; // Not a trace, or truncated
+    }
+    size_ = header->count;
+    records_ = reinterpret_cast<const TraceRecord*>(header + 1);
+    return true;
+}
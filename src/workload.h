@@ -0,0 +1,200 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "zipf.h"
+#include "latest-generator.h"
+#include "skiplist.h"
+
+#define DEFAULT_SEED 1 // Seed of every generated stream unless DASL_SEED is set
+#define SYNTHETIC_MAX_KEY (1ULL << 62) // Synthetic dataset keys stay in [1, SYNTHETIC_MAX_KEY]
+
+// Workload materialization: every key and operation a benchmark issues is drawn
+// before its timed region into flat arrays, so the timed loops only index them.
+// Streams come from a std::mt19937_64 seeded with WorkloadSeed(), which also
+// seeds the zipf and latest generators, so two runs with the same seed issue
+// the same operations.
+
+// Operation of a mixed stream, stored as one byte per key
+enum WorkloadOp : uint8_t { kOpInsert, kOpRead, kOpScan, kOpReadModifyWrite, kOpDeleteRange, kOpDeleteFrom };
+
+inline uint64_t WorkloadSeed() {
+    const char* env = std::getenv("DASL_SEED");
+    return (env != nullptr) ? std::strtoull(env, nullptr, 10) : DEFAULT_SEED;
+}
+
+// Arrival process of the open-loop benchmarks, DASL_ARRIVAL=constant or poisson
+enum ArrivalProcess { kArrivalConstant, kArrivalPoisson };
+
+inline ArrivalProcess WorkloadArrival() {
+    const char* env = std::getenv("DASL_ARRIVAL");
+    return (env != nullptr && std::string(env) == "constant") ? kArrivalConstant : kArrivalPoisson;
+}
+
+// Offered rate in operations per second of the open-loop benchmarks, or 0 to
+// sweep fractions of the measured capacity (DASL_RATE)
+inline double WorkloadRate() {
+    const char* env = std::getenv("DASL_RATE");
+    return (env != nullptr) ? std::strtod(env, nullptr) : 0.0;
+}
+
+// Most threads benchmarks 0~9 are swept over, or 0 to run them on one thread
+// against the shared index (DASL_THREADS)
+inline int WorkloadThreads() {
+    const char* env = std::getenv("DASL_THREADS");
+    return (env != nullptr) ? std::atoi(env) : 0;
+}
+
+// n keys uniform over [lo, hi]
+inline std::vector<Key> UniformKeys(std::mt19937_64& gen, size_t n, Key lo, Key hi) {
+    std::uniform_int_distribution<Key> distr(lo, hi);
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) keys[i] = distr(gen);
+    return keys;
+}
+
+// n zipfian ranks over [0, items], folded into [1, range]
+inline std::vector<Key> ZipfianKeys(std::mt19937_64& gen, size_t n, long items, long range, double theta = ZIPFIAN_CONSTANT) {
+    ZipfianGenerator zipf(0, items, theta, gen());
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) keys[i] = zipf.Next() % range + 1;
+    return keys;
+}
+
+// n zipfian keys over [1, items] with the popular ones scattered by hashing
+inline std::vector<Key> ScrambledZipfianKeys(std::mt19937_64& gen, size_t n, long items, double theta = ZIPFIAN_CONSTANT) {
+    ScrambledZipfianGenerator zipf(1, items, theta, gen());
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) keys[i] = zipf.Next();
+    return keys;
+}
+
+// n keys skewed towards the most recent of items, folded into [1, range]
+inline std::vector<Key> LatestKeys(std::mt19937_64& gen, size_t n, long items, long range, double theta = ZIPFIAN_CONSTANT) {
+    LatestGenerator latest(items, theta, gen());
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) keys[i] = latest.Next() % range + 1;
+    return keys;
+}
+
+// Offline stand-ins for the real-world datasets, shaped after their CDFs
+
+// books: lognormal key popularity, dense at the low end with a long tail
+inline std::vector<Key> LognormalKeys(std::mt19937_64& gen, size_t n) {
+    std::lognormal_distribution<double> distr(0.0, 2.0);
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) keys[i] = (Key)std::min(distr(gen) * 1e12, (double)SYNTHETIC_MAX_KEY) + 1;
+    return keys;
+}
+
+// fb: IDs allocated in blocks, a piecewise-linear CDF of 64 segments with
+// random sizes, positions and strides
+inline std::vector<Key> ClusteredKeys(std::mt19937_64& gen, size_t n) {
+    const int segments = 64;
+    std::exponential_distribution<double> weight(1.0);
+    std::uniform_int_distribution<Key> base(1, SYNTHETIC_MAX_KEY / 2);
+    std::uniform_real_distribution<double> log_stride(0.0, std::log(1000.0));
+    std::vector<double> weights(segments);
+    double total = 0;
+    for (double& w : weights) total += (w = weight(gen));
+
+    std::vector<Key> keys;
+    keys.reserve(n);
+    for (int s = 0; s < segments && keys.size() < n; s++) {
+        size_t count = (s == segments - 1) ? n - keys.size() : std::min(n - keys.size(), (size_t)(n * weights[s] / total));
+        Key start = base(gen);
+        Key stride = (Key)std::exp(log_stride(gen)) + 1;
+        for (size_t j = 0; j < count; j++) keys.push_back(start + j * stride);
+    }
+    return keys;
+}
+
+// wiki: edit timestamps in seconds with a daily rate cycle, so busy seconds
+// repeat the same key many times
+inline std::vector<Key> TimestampKeys(std::mt19937_64& gen, size_t n) {
+    std::exponential_distribution<double> gap(1.0);
+    const double day = 86400, mean_gap = 0.3;
+    double t = 1e9;
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) {
+        double rate = 1.0 + 0.8 * std::sin(2 * M_PI * t / day);
+        t += gap(gen) * mean_gap / rate;
+        keys[i] = (Key)t;
+    }
+    return keys;
+}
+
+// osm: cells of a Z-order curve over points clustered around 256 centers,
+// with a tenth spread uniformly
+inline std::vector<Key> MortonKeys(std::mt19937_64& gen, size_t n) {
+    const int centers = 256;
+    const double side = (double)(1U << 31);
+    std::uniform_real_distribution<double> coord(0, side), log_spread(std::log(side / 1e5), std::log(side / 50));
+    std::uniform_int_distribution<int> pick(0, centers - 1), percent(0, 99);
+    std::normal_distribution<double> normal(0.0, 1.0);
+    std::vector<double> cx(centers), cy(centers), spread(centers);
+    for (int c = 0; c < centers; c++) {
+        cx[c] = coord(gen);
+        cy[c] = coord(gen);
+        spread[c] = std::exp(log_spread(gen));
+    }
+
+    auto cell = [side](double v) { return (uint64_t)std::min(std::max(v, 0.0), side - 1); };
+    auto spread_bits = [](uint64_t v) { // Bit i of v to bit 2i
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        v = (v | (v << 2)) & 0x3333333333333333ULL;
+        v = (v | (v << 1)) & 0x5555555555555555ULL;
+        return v;
+    };
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) {
+        double x, y;
+        if (percent(gen) < 10) {
+            x = coord(gen);
+            y = coord(gen);
+        } else {
+            int c = pick(gen);
+            x = cx[c] + normal(gen) * spread[c];
+            y = cy[c] + normal(gen) * spread[c];
+        }
+        keys[i] = (spread_bits(cell(x)) | (spread_bits(cell(y)) << 1)) + 1;
+    }
+    return keys;
+}
+
+// n keys drawn with replacement from the size keys of a loaded dataset
+inline std::vector<Key> SampleKeys(std::mt19937_64& gen, size_t n, const Key* from, size_t size) {
+    std::uniform_int_distribution<size_t> distr(0, size - 1);
+    std::vector<Key> keys(n);
+    for (size_t i = 0; i < n; i++) keys[i] = from[distr(gen)];
+    return keys;
+}
+
+// n operations, percent of them op and the rest other
+inline std::vector<uint8_t> MixedOps(std::mt19937_64& gen, size_t n, int percent, WorkloadOp op, WorkloadOp other) {
+    std::uniform_int_distribution<int> distr(0, 99);
+    std::vector<uint8_t> ops(n);
+    for (size_t i = 0; i < n; i++) ops[i] = (distr(gen) < percent) ? op : other;
+    return ops;
+}
+
+// Due times in ns after the start of n operations offered at rate per second:
+// evenly spaced, or a Poisson process whose exponential gaps have that mean
+inline std::vector<uint64_t> ArrivalTimes(std::mt19937_64& gen, size_t n, double rate, ArrivalProcess process) {
+    std::exponential_distribution<double> gap(rate);
+    std::vector<uint64_t> due(n);
+    double t = 0;
+    for (size_t i = 0; i < n; i++) {
+        due[i] = (uint64_t)(t * 1e9);
+        t += (process == kArrivalPoisson) ? gap(gen) : 1.0 / rate;
+    }
+    return due;
+}
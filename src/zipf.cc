@@ -1,87 +1,148 @@
 #include "zipf.h"
+#include <algorithm>
 #include <math.h>
-#include <stdlib.h>
-#include <time.h>
+#include <mutex>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 // 	*
 // 	 * Create a zipfian generator for items between min and max (inclusive) for the specified zipfian constant, using the precomputed value of zeta.
-// 	 * 
+// 	 *
 // 	 * @param min The smallest integer to generate in the sequence.
 // 	 * @param max The largest integer to generate in the sequence.
+// 	 * @param theta The zipfian constant to use. 1 makes the closed form singular, so it is approximated from just below.
+// 	 * @param seed Seed of the instance's random source.
+
+ZipfianGenerator::ZipfianGenerator(long min, long max, double theta, uint64_t seed)
+	: items_(max - min + 1), base_(min), theta_(theta), last_(min), gen_(seed), uniform_(0.0, 1.0) {
+	if (fabs(theta_ - 1.0) < 1e-6) theta_ = 1.0 - 1e-6;
+	zeta2theta_ = Zeta(0, 2, 0);
+	alpha_ = 1.0 / (1.0 - theta_);
+	zetan_ = Zeta(0, items_, 0);
+	countforzeta_ = items_;
+	eta_ = (1 - pow(2.0 / items_, 1 - theta_)) / (1 - zeta2theta_ / zetan_);
+
+	Next();
+}
+
+// Sum of i^-theta for i in [a, b], term by term
+static double ZetaExact(long a, long b, double theta) {
+	double sum = 0;
+	for (long i = a; i <= b; i++) {
+		sum += 1 / (pow(i, theta));
+	}
+	return sum;
+}
+
+// Sum of i^-theta for i in [a, b]: the first terms up to ZETA_EXACT_TERMS
+// exactly, the rest by Euler-Maclaurin (integral, end point and two derivative
+// corrections), whose error there is far below double precision
+static double ZetaApprox(long a, long b, double theta) {
+	long m = std::min(b, std::max(a - 1, (long)ZETA_EXACT_TERMS));
+	double sum = ZetaExact(a, m, theta);
+	if (m >= b) return sum;
 
+	auto f = [theta](double x) { return pow(x, -theta); };
+	auto f1 = [theta](double x) { return -theta * pow(x, -theta - 1); };
+	auto f3 = [theta](double x) { return -theta * (theta + 1) * (theta + 2) * pow(x, -theta - 3); };
+	double integral = pow(m, 1 - theta) * expm1((1 - theta) * log((double)b / m)) / (1 - theta);
+	return sum + integral + (f(b) - f(m)) / 2 + (f1(b) - f1(m)) / 12 - (f3(b) - f3(m)) / 720;
+}
 
-long items; //initialized in init_zipf_generator function
-long base; //initialized in init_zipf_generator function
-double zipfianconstant; //initialized in init_zipf_generator function
-double alpha; //initialized in init_zipf_generator function
-double zetan; //initialized in init_zipf_generator function
-double eta; //initialized in init_zipf_generator function
-double theta; //initialized in init_zipf_generator function
-double zeta2theta; //initialized in init_zipf_generator function
-long countforzeta; //initialized in init_zipf_generator function
-long lastVal; //initialized in setLastValue
-
-void init_zipf_generator(long min, long max){
-	items = max-min+1;
-	base = min;
-	zipfianconstant = 0.8;
-	theta = zipfianconstant;
-	zeta2theta = zeta(0, 2, 0);
-	alpha = 1.0/(1.0-theta);
-	zetan = zetastatic(0, max-min+1, 0);
-	countforzeta = items;
-	eta=(1 - pow(2.0/items,1-theta) )/(1-zeta2theta/zetan);
-
-	nextValue();
+// DASL_ZETA=exact sums zeta term by term as before, caching the results
+static bool UseExactZeta() {
+	static const bool exact = [] {
+		const char* env = getenv("DASL_ZETA");
+		return env != nullptr && strcmp(env, "exact") == 0;
+	}();
+	return exact;
 }
 
+// Exact zeta(n, theta) from the cache file, computed and appended on a miss.
+// Lines are "n theta-bits zeta" so lookups compare theta exactly.
+static double ZetaCached(long n, double theta) {
+	static std::mutex mutex;
+	std::lock_guard<std::mutex> lock(mutex);
+
+	const char* env = getenv("DASL_ZETA_CACHE");
+	const char* path = (env != nullptr) ? env : ZETA_CACHE_FILE;
+	uint64_t bits;
+	memcpy(&bits, &theta, sizeof(bits));
 
-double zeta(long st, long n, double initialsum) {
-	countforzeta=n;
-	return zetastatic(st,n,initialsum);
+	FILE* file = fopen(path, "r");
+	if (file != nullptr) {
+		long cached_n;
+		unsigned long long cached_bits;
+		double zeta;
+		while (fscanf(file, "%ld %llx %la", &cached_n, &cached_bits, &zeta) == 3) {
+			if (cached_n == n && cached_bits == bits) {
+				fclose(file);
+				return zeta;
+			}
+		}
+		fclose(file);
+	}
+
+	double zeta = ZetaExact(1, n, theta);
+	file = fopen(path, "a");
+	if (file != nullptr) {
+		fprintf(file, "%ld %llx %a\n", n, (unsigned long long)bits, zeta);
+		fclose(file);
+	}
+	return zeta;
 }
 
 //initialsum is the value of zeta we are computing incrementally from
-double zetastatic(long st, long n, double initialsum){
-	double sum=initialsum;
-	for (long i=st; i<n; i++){
-		sum+=1/(pow(i+1,theta));
-	}				
-	return sum;
+double ZipfianGenerator::Zeta(long st, long n, double initialsum) const {
+	if (!UseExactZeta()) return initialsum + ZetaApprox(st + 1, n, theta_);
+	if (st == 0 && n > ZETA_EXACT_TERMS) return ZetaCached(n, theta_);
+	return initialsum + ZetaExact(st + 1, n, theta_);
 }
 
-long nextLong(long itemcount){
+long ZipfianGenerator::Next(long itemcount) {
 	//from "Quickly Generating Billion-Record Synthetic Databases", Jim Gray et al, SIGMOD 1994
-	if (itemcount!=countforzeta){
-		if (itemcount>countforzeta){
-			printf("WARNING: Incrementally recomputing Zipfian distribtion. (itemcount= %ld; countforzeta= %ld)", itemcount, countforzeta);
-			//we have added more items. can compute zetan incrementally, which is cheaper
-			zetan = zeta(countforzeta,itemcount,zetan);
-			eta = ( 1 - pow(2.0/items,1-theta) ) / (1-zeta2theta/zetan);
-		} 
+	if (itemcount > countforzeta_) {
+		printf("WARNING: Incrementally recomputing Zipfian distribtion. (itemcount= %ld; countforzeta= %ld)", itemcount, countforzeta_);
+		//we have added more items. can compute zetan incrementally, which is cheaper
+		zetan_ = Zeta(countforzeta_, itemcount, zetan_);
+		countforzeta_ = itemcount;
+		eta_ = (1 - pow(2.0 / items_, 1 - theta_)) / (1 - zeta2theta_ / zetan_);
 	}
-	
-	double u = (double)rand() / ((double)RAND_MAX);
-	double uz=u*zetan;
-	if (uz < 1.0){
-		return base;
+
+	double u = uniform_(gen_);
+	double uz = u * zetan_;
+	if (uz < 1.0) {
+		return last_ = base_;
 	}
-	
-	if (uz<1.0 + pow(0.5,theta)) {
-		return base + 1;
+
+	if (uz < 1.0 + pow(0.5, theta_)) {
+		return last_ = base_ + 1;
 	}
-	long ret = base + (long)((itemcount) * pow(eta*u - eta + 1, alpha));
-	setLastValue(ret);
-	return ret;
+	long ret = base_ + (long)((itemcount) * pow(eta_ * u - eta_ + 1, alpha_));
+	if (ret >= base_ + itemcount) ret = base_ + itemcount - 1; // Rounding can reach itemcount as u approaches 1
+	return last_ = ret;
 }
 
-long nextValue() {
-	return nextLong(items);
+long ZipfianGenerator::Next() {
+	return Next(items_);
 }
 
-void setLastValue(long val){
-	lastVal = val;
+// FNV-1a over the eight bytes of val, as YCSB's Utils.fnvhash64
+uint64_t FnvHash64(uint64_t val) {
+	uint64_t hashval = 0xCBF29CE484222325ULL;
+	for (int i = 0; i < 8; i++) {
+		uint64_t octet = val & 0x00ff;
+		val = val >> 8;
+		hashval = hashval ^ octet;
+		hashval = hashval * 1099511628211ULL;
+	}
+	return hashval;
 }
 
+ScrambledZipfianGenerator::ScrambledZipfianGenerator(long min, long max, double theta, uint64_t seed)
+	: min_(min), items_(max - min + 1), last_(min), zipf_(0, max - min, theta, seed) {}
 
+long ScrambledZipfianGenerator::Next() {
+	return last_ = min_ + (long)(FnvHash64(zipf_.Next()) % items_);
+}
@@ -1,17 +1,57 @@
-extern long items; //initialized in init_zipf_generator function
-//extern long base; //initialized in init_zipf_generator function
-extern double zipfianconstant; //initialized in init_zipf_generator function
-extern double alpha; //initialized in init_zipf_generator function
-extern double zetan; //initialized in init_zipf_generator function
-extern double eta; //initialized in init_zipf_generator function
-extern double theta; //initialized in init_zipf_generator function
-extern double zeta2theta; //initialized in init_zipf_generator function
-extern long countforzeta; //initialized in init_zipf_generator function
-extern long lastVal; //initialized in setLastValue
-
-void init_zipf_generator(long min, long max);
-double zeta(long st, long n, double initialsum);
-double zetastatic(long st, long n, double initialsum);
-long nextLong(long itemcount);
-long nextValue();
-void setLastValue(long val);
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#define ZIPFIAN_CONSTANT 0.8 // Default skew (theta) of the generators
+#define ZETA_EXACT_TERMS 1024 // Terms of zeta summed directly before the approximated tail
+#define ZETA_CACHE_FILE "zeta.cache" // Exact zeta values kept across runs, DASL_ZETA_CACHE to override
+
+// Zipfian generator over the integers in [min, max] after Gray et al.,
+// "Quickly Generating Billion-Record Synthetic Databases", SIGMOD 1994, as in
+// YCSB. All state, including the random source, belongs to the instance, so
+// generators with different skews can run on different threads. Small values
+// are the popular ones.
+class ZipfianGenerator {
+   public:
+	ZipfianGenerator(long min, long max, double theta = ZIPFIAN_CONSTANT, uint64_t seed = 0);
+
+	long Next(); // Next value in [min, max]
+	long Next(long itemcount); // Next value in [min, min + itemcount), growing zeta incrementally if itemcount is larger
+	inline long Last() const { return last_; }
+	inline double Theta() const { return theta_; }
+
+   private:
+	long items_;
+	long base_;
+	double theta_;
+	double alpha_;
+	double zetan_;
+	double eta_;
+	double zeta2theta_;
+	long countforzeta_;
+	long last_;
+	std::mt19937_64 gen_;
+	std::uniform_real_distribution<double> uniform_;
+
+	double Zeta(long st, long n, double initialsum) const;
+};
+
+// YCSB's scrambled Zipfian: Zipfian ranks hashed with FNV-1a over [min, max],
+// so the popular values are spread over the key space instead of clustered at
+// min. The popularity distribution is the same as ZipfianGenerator's.
+class ScrambledZipfianGenerator {
+   public:
+	ScrambledZipfianGenerator(long min, long max, double theta = ZIPFIAN_CONSTANT, uint64_t seed = 0);
+
+	long Next();
+	inline long Last() const { return last_; }
+
+   private:
+	long min_;
+	long items_;
+	long last_;
+	ZipfianGenerator zipf_;
+};
+
+uint64_t FnvHash64(uint64_t val);